@@ -0,0 +1,82 @@
+#include "Autotuner.h"
+
+void Autotuner::reset(const Settings& start) {
+    m_current = start;
+    m_best = start;
+    m_bestRate = 0.f;
+    m_frames = 0;
+    m_sticks = 0;
+    m_stepMicros = 0;
+    m_frameSeconds = 0.0;
+    m_knob = Knob::Walkers;
+    m_walkerDir = +1;
+    m_lastEfficiency = -1.f;
+    m_budgetHold = 0;
+}
+
+void Autotuner::addSample(int sticks, uint64_t stepMicros, float frameSeconds) {
+    ++m_frames;
+    m_sticks += sticks;
+    m_stepMicros += stepMicros;
+    m_frameSeconds += frameSeconds;
+}
+
+bool Autotuner::update(Settings& s, float targetFps) {
+    if (m_frames < windowFrames) return false;
+    if (m_sticks < minSticks && m_frames < windowFrames * 4) return false;
+
+    const float cpuMs = std::max(1e-3f, m_stepMicros / 1000.f);
+    const float efficiency = m_sticks / cpuMs;                        // sticks per CPU-ms
+    const float fps = m_frameSeconds > 0.0 ? (float)(m_frames / m_frameSeconds) : targetFps;
+    const float rate = m_frameSeconds > 0.0 ? (float)(m_sticks / m_frameSeconds) : 0.f; // sticks/s
+
+    m_frames = 0;
+    m_sticks = 0;
+    m_stepMicros = 0;
+    m_frameSeconds = 0.0;
+
+    if (fps >= targetFps * 0.95f && rate > m_bestRate) {
+        m_bestRate = rate;
+        m_best = m_current;
+    }
+
+    Settings next = m_current;
+    std::string reason;
+
+    if (fps < targetFps * 0.95f) {
+        // Frame rate comes first, whichever knob's turn it is
+        next.budgetMs = std::max(minBudgetMs, m_current.budgetMs - 1);
+        m_budgetHold = 4;
+        reason = "fps below target";
+    } else if (m_knob == Knob::Walkers) {
+        if (m_lastEfficiency >= 0.f && efficiency < m_lastEfficiency) {
+            m_walkerDir = -m_walkerDir; // last move hurt; head back the other way
+            reason = "efficiency fell, reversing";
+        } else {
+            reason = "efficiency held, continuing";
+        }
+        m_lastEfficiency = efficiency;
+        next.walkers = std::min(maxWalkers, std::max(minWalkers, m_current.walkers + m_walkerDir * walkerStep));
+        if (next.walkers == m_current.walkers) m_walkerDir = -m_walkerDir;
+        m_knob = Knob::Budget;
+    } else {
+        if (m_budgetHold > 0) {
+            --m_budgetHold;
+        } else if (m_current.budgetMs < maxBudgetMs) {
+            next.budgetMs = m_current.budgetMs + 1;
+            reason = "fps at target, growing budget";
+        }
+        m_knob = Knob::Walkers;
+    }
+
+    if (next.walkers == m_current.walkers && next.budgetMs == m_current.budgetMs) return false;
+
+    ofLogNotice("Autotuner") << "numWalkers " << m_current.walkers << " -> " << next.walkers
+        << ", frameBudgetMs " << m_current.budgetMs << " -> " << next.budgetMs
+        << " (" << reason << "; sticks/cpu-ms=" << efficiency << " sticks/s=" << rate
+        << " fps=" << fps << ")";
+
+    m_current = next;
+    s = next;
+    return true;
+}
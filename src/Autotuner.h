@@ -0,0 +1,49 @@
+#pragma once
+#include "ofMain.h"
+
+// Online controller for walker count and per-frame stepping budget.
+//
+// Each frame reports how many nodes stuck and how much CPU time stepping took. Over a window of
+// frames the tuner
+//  - hill-climbs walker count (in steps of 64) on sticks per CPU-millisecond, and
+//  - grows the frame budget while the frame rate holds at the target, shrinking it when it drops.
+// The two knobs are moved in alternate windows so each change is measured on its own.
+// Stick rate is proportional to efficiency x budget, so this maximises growth at the target rate.
+class Autotuner {
+public:
+    struct Settings {
+        int walkers = 1024;
+        int budgetMs = 6;
+    };
+
+    void reset(const Settings& start);
+    void addSample(int sticks, uint64_t stepMicros, float frameSeconds);
+    // Returns true (and writes s) when the settings should change
+    bool update(Settings& s, float targetFps);
+
+    Settings best() const { return m_best; }
+    float bestRate() const { return m_bestRate; }
+
+    int minWalkers = 32, maxWalkers = 8192, walkerStep = 64;
+    int minBudgetMs = 1, maxBudgetMs = 16;
+    int windowFrames = 60;   // frames per measurement window
+    int minSticks = 20;      // windows with fewer sticks are extended, too noisy to judge
+
+private:
+    enum class Knob { Walkers, Budget };
+
+    Settings m_current;
+    Settings m_best;
+    float m_bestRate = 0.f;
+
+    // window accumulators
+    int m_frames = 0;
+    int m_sticks = 0;
+    uint64_t m_stepMicros = 0;
+    double m_frameSeconds = 0.0;
+
+    Knob m_knob = Knob::Walkers;
+    int m_walkerDir = +1;
+    float m_lastEfficiency = -1.f; // sticks per CPU-ms in the last walker window
+    int m_budgetHold = 0;          // windows to wait before growing the budget again
+};
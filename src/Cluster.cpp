@@ -1,11 +1,30 @@
 #include "Cluster.h"
+#include <cstring>
+#include <fstream>
+
+namespace {
+const char kCheckpointMagic[4] = { 'D', 'L', 'A', 'C' };
+const uint32_t kCheckpointVersion = 1;
+}
 
 Cluster::Cluster() : m_hash(8.0f) {}
 
 void Cluster::reset() {
     m_nodes.clear();
+    m_slotOfId.clear();
+    m_subtreeMass.clear();
+    m_strahler.clear();
+    m_childCount.clear();
+    m_tipIndex.clear();
+    m_maxChildOrder.clear();
+    m_maxChildCount.clear();
+    m_pendingMass.clear();
+    m_tips.clear();
+    m_massDirty.clear();
     m_hash.clear();
     m_extent = 0.f;
+    m_sortedCount = 0;
+    ++m_layoutEpoch;
 }
 
 void Cluster::clear() { reset(); }
@@ -13,22 +32,144 @@ void Cluster::clear() { reset(); }
 void Cluster::addSeed(const glm::vec2& p) {
     ClusterNode seed;
     seed.pos = p;
+    seed.id = (int)m_slotOfId.size();
     seed.parent = -1;
+    seed.parentSlot = -1;
     seed.depth = 0;
+    m_slotOfId.push_back((int)m_nodes.size());
     m_nodes.push_back(seed);
-    m_hash.insert(p, 0);
+    linkTopology(seed.id, -1);
+    m_hash.insert(p, (int)m_nodes.size() - 1);
     m_extent = std::max(m_extent, glm::length(p));
 }
 
-void Cluster::addNode(const glm::vec2& p, int parentIndex) {
+void Cluster::addNode(const glm::vec2& p, int parentId) {
     ClusterNode n;
     n.pos = p;
-    n.parent = parentIndex;
-    n.depth = (parentIndex >= 0 && parentIndex < (int)m_nodes.size())
-        ? m_nodes[parentIndex].depth + 1 : 0;
+    n.id = (int)m_slotOfId.size();
+    n.parent = parentId;
+    bool hasParent = parentId >= 0 && parentId < (int)m_slotOfId.size();
+    n.parentSlot = hasParent ? m_slotOfId[parentId] : -1;
+    n.depth = hasParent ? m_nodes[n.parentSlot].depth + 1 : 0;
+    m_slotOfId.push_back((int)m_nodes.size());
     m_nodes.push_back(n);
+    linkTopology(n.id, hasParent ? parentId : -1);
     m_hash.insert(p, (int)m_nodes.size() - 1);
     m_extent = std::max(m_extent, glm::length(p));
+    maybeRelayout();
+}
+
+// New leaf id: becomes a tip, its parent stops being one, Strahler orders are raised up the
+// chain while they change (each node's order rises at most log2(N) times), and the parent's
+// pending mass is queued for the next flushTopology().
+void Cluster::linkTopology(int id, int parentId) {
+    m_subtreeMass.push_back(1);
+    m_strahler.push_back(1);
+    m_childCount.push_back(0);
+    m_maxChildOrder.push_back(0);
+    m_maxChildCount.push_back(0);
+    m_pendingMass.push_back(0);
+
+    if (parentId >= 0 && m_childCount[parentId]++ == 0) {
+        // swap-remove the parent from the tip set
+        int last = m_tips.back();
+        m_tips[m_tipIndex[parentId]] = last;
+        m_tipIndex[last] = m_tipIndex[parentId];
+        m_tips.pop_back();
+        m_tipIndex[parentId] = -1;
+    }
+    m_tipIndex.push_back((int)m_tips.size());
+    m_tips.push_back(id);
+    if (parentId < 0) return;
+
+    if (m_pendingMass[parentId]++ == 0) m_massDirty.push_back(parentId);
+
+    int childOrder = 1;
+    for (int v = parentId; v >= 0; v = nodeById(v).parent) {
+        if (childOrder > m_maxChildOrder[v]) {
+            m_maxChildOrder[v] = childOrder;
+            m_maxChildCount[v] = 1;
+        } else if (childOrder == m_maxChildOrder[v]) {
+            ++m_maxChildCount[v];
+        } else {
+            break;
+        }
+        int order = m_maxChildCount[v] >= 2 ? m_maxChildOrder[v] + 1 : std::max(1, m_maxChildOrder[v]);
+        if (order == m_strahler[v]) break;
+        m_strahler[v] = order;
+        childOrder = order;
+    }
+}
+
+void Cluster::flushTopology() {
+    if (m_massDirty.empty()) return;
+    // Deepest first, so a node's pending mass is complete before it moves to its parent
+    auto deeper = [this](int a, int b) { return nodeById(a).depth < nodeById(b).depth; };
+    std::make_heap(m_massDirty.begin(), m_massDirty.end(), deeper);
+    while (!m_massDirty.empty()) {
+        std::pop_heap(m_massDirty.begin(), m_massDirty.end(), deeper);
+        int v = m_massDirty.back();
+        m_massDirty.pop_back();
+
+        m_subtreeMass[v] += m_pendingMass[v];
+        int parent = nodeById(v).parent;
+        if (parent >= 0) {
+            if (m_pendingMass[parent] == 0) {
+                m_massDirty.push_back(parent);
+                std::push_heap(m_massDirty.begin(), m_massDirty.end(), deeper);
+            }
+            m_pendingMass[parent] += m_pendingMass[v];
+        }
+        m_pendingMass[v] = 0;
+    }
+}
+
+void Cluster::maybeRelayout() {
+    const size_t kMinNodes = 4096; // below this everything fits in cache anyway
+    if (!m_spatialLayout || m_nodes.size() < kMinNodes) return;
+    if ((m_nodes.size() - m_sortedCount) * 4 < m_sortedCount) return;
+    relayout();
+}
+
+namespace {
+// Spread the low 16 bits of v over the even bit positions
+uint32_t part1By1(uint32_t v) {
+    v &= 0x0000ffff;
+    v = (v | (v << 8)) & 0x00ff00ff;
+    v = (v | (v << 4)) & 0x0f0f0f0f;
+    v = (v | (v << 2)) & 0x33333333;
+    v = (v | (v << 1)) & 0x55555555;
+    return v;
+}
+}
+
+void Cluster::relayout() {
+    const float range = std::max(m_extent, 1.f);
+    const float scale = 65535.f / (2.f * range);
+
+    std::vector<std::pair<uint32_t, int>> order;
+    order.reserve(m_nodes.size());
+    for (int slot = 0; slot < (int)m_nodes.size(); ++slot) {
+        const glm::vec2& p = m_nodes[slot].pos;
+        uint32_t qx = (uint32_t)ofClamp((p.x + range) * scale, 0.f, 65535.f);
+        uint32_t qy = (uint32_t)ofClamp((p.y + range) * scale, 0.f, 65535.f);
+        order.emplace_back(part1By1(qx) | (part1By1(qy) << 1), slot);
+    }
+    std::sort(order.begin(), order.end());
+
+    std::vector<ClusterNode> sorted;
+    sorted.reserve(m_nodes.capacity());
+    for (const auto& o : order) {
+        m_slotOfId[m_nodes[o.second].id] = (int)sorted.size();
+        sorted.push_back(m_nodes[o.second]);
+    }
+    for (auto& n : sorted) n.parentSlot = n.parent >= 0 ? m_slotOfId[n.parent] : -1;
+    m_nodes.swap(sorted);
+    m_sortedCount = m_nodes.size();
+    ++m_layoutEpoch;
+
+    // Hash buckets hold slots
+    rebuildHash(m_hash.getCellSize());
 }
 
 void Cluster::rebuildHash(float cellSize) {
@@ -42,3 +183,59 @@ void Cluster::rebuildHash(float cellSize) {
 void Cluster::queryNeighbors(const glm::vec2& p, std::vector<int>& out) const {
     m_hash.queryNeighbors(p, out);
 }
+
+bool Cluster::save(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+    uint32_t count = (uint32_t)m_nodes.size();
+    out.write(kCheckpointMagic, sizeof(kCheckpointMagic));
+    out.write(reinterpret_cast<const char*>(&kCheckpointVersion), sizeof(kCheckpointVersion));
+    out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    for (int id = 0; id < (int)m_nodes.size(); ++id) {
+        const ClusterNode& n = nodeById(id);
+        int32_t parent = n.parent;
+        out.write(reinterpret_cast<const char*>(&n.pos.x), sizeof(float));
+        out.write(reinterpret_cast<const char*>(&n.pos.y), sizeof(float));
+        out.write(reinterpret_cast<const char*>(&parent), sizeof(parent));
+    }
+    return (bool)out;
+}
+
+bool Cluster::load(const std::string& path, uint32_t maxNodes) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) return false;
+    const uint64_t fileSize = (uint64_t)in.tellg();
+    in.seekg(0);
+    char magic[4];
+    uint32_t version = 0, count = 0;
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(&version), sizeof(version));
+    in.read(reinterpret_cast<char*>(&count), sizeof(count));
+    if (!in || std::memcmp(magic, kCheckpointMagic, sizeof(magic)) != 0 || version != kCheckpointVersion) {
+        return false;
+    }
+    const uint64_t kHeaderBytes = sizeof(kCheckpointMagic) + 2 * sizeof(uint32_t);
+    const uint64_t kRecordBytes = 2 * sizeof(float) + sizeof(int32_t);
+    if (count == 0 || count > maxNodes || fileSize != kHeaderBytes + (uint64_t)count * kRecordBytes) {
+        return false;
+    }
+
+    std::vector<ClusterNode> loaded(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        int32_t parent;
+        in.read(reinterpret_cast<char*>(&loaded[i].pos.x), sizeof(float));
+        in.read(reinterpret_cast<char*>(&loaded[i].pos.y), sizeof(float));
+        in.read(reinterpret_cast<char*>(&parent), sizeof(parent));
+        // The seed comes first and parents always precede children in stick order
+        if (!in || parent >= (int32_t)i || (parent < 0) != (i == 0)) return false;
+        loaded[i].parent = parent;
+    }
+
+    reset();
+    for (const auto& n : loaded) {
+        if (n.parent < 0) addSeed(n.pos);
+        else addNode(n.pos, n.parent);
+    }
+    flushTopology();
+    return true;
+}
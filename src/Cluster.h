@@ -4,8 +4,10 @@
 
 struct ClusterNode {
     glm::vec2 pos;
-    int parent = -1;  // index of parent node (nearest upon sticking), -1 for seed
-    int depth = 0;    // steps from seed
+    int id = 0;          // stable index in stick order; never changes
+    int parent = -1;     // stable id of parent node (nearest upon sticking), -1 for seed
+    int parentSlot = -1; // parent's current position in nodes(); rewritten on relayout
+    int depth = 0;       // steps from seed
 };
 
 class Cluster {
@@ -14,22 +16,70 @@ public:
 
     void reset();
     void addSeed(const glm::vec2& p);
-    // Add node, record parent and depth; updates extent and hash
-    void addNode(const glm::vec2& p, int parentIndex);
+    // Add node, record parent (stable id) and depth; updates extent and hash
+    void addNode(const glm::vec2& p, int parentId);
     void rebuildHash(float cellSize);
+    // Propagate subtree-mass increments batched since the last call up the parent chains.
+    // Each ancestor is visited once per call, however many descendants stuck below it.
+    void flushTopology();
     void clear();
 
+    // Checkpoint: binary node list (pos, parent) in stick order
+    bool save(const std::string& path) const;
+    // Replaces the cluster (caller rebuilds the hash). Files claiming more than maxNodes nodes,
+    // or more than they actually contain, are rejected before anything is allocated.
+    bool load(const std::string& path, uint32_t maxNodes);
+
+    // Storage order: Morton (Z-order) sorted prefix plus nodes stuck since the last relayout.
+    // Iterate this for anything order-independent; use ids for stick order.
     const std::vector<ClusterNode>& nodes() const { return m_nodes; }
-    std::vector<ClusterNode>& nodes() { return m_nodes; }
+    size_t size() const { return m_nodes.size(); }
+    int slotOf(int id) const { return m_slotOfId[id]; }
+    const ClusterNode& nodeById(int id) const { return m_nodes[m_slotOfId[id]]; }
+
+    // Periodically re-sort storage in Z-order so spatial neighbours share cache lines.
+    // Amortized: a relayout happens once the unsorted tail reaches a quarter of the sorted part.
+    void setSpatialLayout(bool enabled) { m_spatialLayout = enabled; }
+    int layoutEpoch() const { return m_layoutEpoch; } // bumps whenever slots move
+
+    // Tree topology per stable id, maintained incrementally as nodes stick. Kept out of
+    // ClusterNode so neighbour queries and relayouts only touch position/parent data.
+    int subtreeMass(int id) const { return m_subtreeMass[id]; } // exact after flushTopology()
+    int strahler(int id) const { return m_strahler[id]; }       // Horton-Strahler order; 1 for tips
+    int childCount(int id) const { return m_childCount[id]; }
+    bool isTip(int id) const { return m_childCount[id] == 0; }
+    // Stable ids of nodes without children (the growth front)
+    const std::vector<int>& tips() const { return m_tips; }
+    int maxStrahler() const { return m_strahler.empty() ? 0 : m_strahler[0]; }
 
     float extent() const { return m_extent; } // max radius from origin
     glm::vec2 centroid() const { return {0,0}; } // we center world at (0,0)
 
-    // neighbor search (candidate indices)
+    // neighbor search (candidate slots into nodes())
     void queryNeighbors(const glm::vec2& p, std::vector<int>& out) const;
 
 private:
+    void maybeRelayout();
+    void relayout();
+    void linkTopology(int id, int parentId);
+
     std::vector<ClusterNode> m_nodes;
+    std::vector<int> m_slotOfId;
+
+    // Topology, indexed by stable id
+    std::vector<int> m_subtreeMass;
+    std::vector<int> m_strahler;
+    std::vector<int> m_childCount;
+    std::vector<int> m_tipIndex;      // position in m_tips, -1 once the node has children
+    std::vector<int> m_maxChildOrder; // highest Strahler order among children
+    std::vector<int> m_maxChildCount; // children with that order
+    std::vector<int> m_pendingMass;   // mass not yet propagated to m_subtreeMass
+    std::vector<int> m_tips;          // stable ids
+    std::vector<int> m_massDirty;     // stable ids with pending mass
     SpatialHash m_hash;
     float m_extent = 0.f;
+
+    bool m_spatialLayout = true;
+    size_t m_sortedCount = 0;
+    int m_layoutEpoch = 0;
 };
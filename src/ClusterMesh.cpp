@@ -0,0 +1,236 @@
+#include "ClusterMesh.h"
+
+namespace {
+
+const int kCircleResolution = 12; // slightly higher for smoother spheres
+const int kPointVertices = kCircleResolution * 3;
+const int kMinNodesPerChunk = 2048; // below this, waking workers costs more than it saves
+
+// Segments used for the full-detail edge from n to its parent, 0 if it is not drawn
+int edgeSegments(const std::vector<ClusterNode>& nodes, const ClusterNode& n) {
+    if (n.parentSlot < 0) return 0;
+    float lineLength = glm::length(n.pos - nodes[n.parentSlot].pos);
+    if (lineLength < 0.01f) return 0;
+    int segments = std::max(2, (int)(lineLength / 12.0f));
+    return std::min(segments, 5); // cap for performance
+}
+
+// Exclusive prefix sum in place; returns the total
+uint32_t prefixSum(std::vector<uint32_t>& v) {
+    uint32_t total = 0;
+    for (auto& x : v) {
+        uint32_t c = x;
+        x = total;
+        total += c;
+    }
+    return total;
+}
+
+void setVertex(glm::vec3* v, ofFloatColor* c, glm::vec2* t, uint32_t i,
+               const glm::vec2& pos, const ofFloatColor& color, const glm::vec2& tex) {
+    v[i] = glm::vec3(pos, 0);
+    c[i] = color;
+    t[i] = tex;
+}
+
+}
+
+ClusterMesh::ClusterMesh() {
+    m_lines.setMode(OF_PRIMITIVE_TRIANGLES);
+    m_points.setMode(OF_PRIMITIVE_TRIANGLES);
+}
+
+// Nodes only ever get appended between relayouts, and without topology shading a node's
+// geometry never changes once it has stuck, so growth only needs the new nodes' vertices
+bool ClusterMesh::Key::appendable(const Key& newer) const {
+    return newer.layoutEpoch == layoutEpoch && newer.style == style && !style.topologyShading &&
+           newer.nodes > nodes;
+}
+
+void ClusterMesh::update(const Cluster& cluster, const Style& style, bool wantLines, bool wantPoints) {
+    Key key{ cluster.size(), cluster.layoutEpoch(), style };
+    if (wantLines && !(m_linesValid && m_linesKey == key)) {
+        buildLines(cluster, style, m_linesValid && m_linesKey.appendable(key) ? m_linesKey.nodes : 0);
+        m_linesKey = key;
+        m_linesValid = true;
+    }
+    if (wantPoints && !(m_pointsValid && m_pointsKey == key)) {
+        buildPoints(cluster, style, m_pointsValid && m_pointsKey.appendable(key) ? m_pointsKey.nodes : 0);
+        m_pointsKey = key;
+        m_pointsValid = true;
+    }
+}
+
+void ClusterMesh::buildLines(const Cluster& cluster, const Style& style, size_t fromNode) {
+    const auto& nodes = cluster.nodes();
+    const int stride = std::max(1, style.stride);
+    const int drawn = ((int)nodes.size() + stride - 1) / stride;
+    const int first = ((int)fromNode + stride - 1) / stride; // drawn nodes [0, first) are kept
+
+    auto& verts = m_lines.getVertices();
+    auto& colors = m_lines.getColors();
+    auto& texs = m_lines.getTexCoords();
+    const uint32_t kept = first > 0 ? (uint32_t)verts.size() : 0;
+
+    // Pass 1: vertices per new drawn node -> offsets (m_offsets[k - first] for drawn node k)
+    m_offsets.assign(drawn - first, 0);
+    m_pool.parallelFor(drawn - first, kMinNodesPerChunk, [&](int begin, int end) {
+        for (int j = begin; j < end; ++j) {
+            const auto& n = nodes[(size_t)(first + j) * stride];
+            if (stride == 1) m_offsets[j] = edgeSegments(nodes, n) * 6;
+            else m_offsets[j] = n.parentSlot >= 0 ? 6 : 0;
+        }
+    });
+    const uint32_t total = kept + prefixSum(m_offsets);
+
+    verts.resize(total);
+    colors.resize(total);
+    texs.resize(total);
+    glm::vec3* V = verts.data();
+    ofFloatColor* C = colors.data();
+    glm::vec2* T = texs.data();
+
+    // Pass 2: every chunk writes its own disjoint vertex range
+    if (stride == 1) {
+        m_pool.parallelFor(drawn - first, kMinNodesPerChunk, [&](int begin, int end) {
+            for (int j = begin; j < end; ++j) {
+                const auto& n = nodes[first + j];
+                int segments = edgeSegments(nodes, n);
+                if (segments == 0) continue;
+                const auto& p = nodes[n.parentSlot];
+                uint32_t o = kept + m_offsets[j];
+
+                // Calculate line properties
+                glm::vec2 dir = n.pos - p.pos;
+                float lineLength = glm::length(dir);
+                dir = glm::normalize(dir);
+                glm::vec2 perpendicular(-dir.y, dir.x);
+
+                // Vary thickness based on depth (deeper = thicker), or on the mass the edge carries
+                float baseThickness = style.topologyShading
+                    ? std::min(0.8f + 0.2f * std::log2((float)cluster.subtreeMass(n.id)), 4.0f)
+                    : std::min(1.2f + n.depth * 0.003f, 2.5f);
+
+                // Create curved line with multiple segments for organic look
+                for (int seg = 0; seg < segments; seg++) {
+                    float t1 = seg / (float)segments;
+                    float t2 = (seg + 1) / (float)segments;
+
+                    // Interpolate positions
+                    glm::vec2 pos1 = p.pos + dir * (lineLength * t1);
+                    glm::vec2 pos2 = p.pos + dir * (lineLength * t2);
+
+                    // Add very subtle organic wave displacement (reduced)
+                    float waveFreq = 0.2f + (n.id % 10) * 0.03f; // vary per line
+                    float wave1 = sin(t1 * 6.28f * waveFreq + n.id * 0.1f) * lineLength * 0.03f;
+                    float wave2 = sin(t2 * 6.28f * waveFreq + n.id * 0.1f) * lineLength * 0.03f;
+
+                    pos1 += perpendicular * wave1;
+                    pos2 += perpendicular * wave2;
+
+                    // Thickness taper (thinner at child end) - less taper for consistency
+                    float thickness1 = baseThickness * (0.8f + t1 * 0.2f);
+                    float thickness2 = baseThickness * (0.8f + t2 * 0.2f);
+
+                    // Color variation along line; main branches (high Strahler order) brightest
+                    int alphaBase = style.topologyShading ? cluster.strahler(n.id) * 140 / style.maxOrder : n.depth;
+                    int alpha1 = ofClamp(40 + alphaBase + (int)(t1 * 40), 40, 180);
+                    int alpha2 = ofClamp(40 + alphaBase + (int)(t2 * 40), 40, 180);
+                    ofFloatColor color1 = ofColor(255, 255, 255, alpha1);
+                    ofFloatColor color2 = ofColor(255, 255, 255, alpha2);
+
+                    // Create quad as two triangles
+                    glm::vec2 newPerp = glm::normalize(glm::vec2(-(pos2.y - pos1.y), pos2.x - pos1.x));
+
+                    // Triangle 1
+                    setVertex(V, C, T, o++, pos1 + newPerp * thickness1, color1, glm::vec2(t1, 0.0)); // flowing texture coord
+                    setVertex(V, C, T, o++, pos1 - newPerp * thickness1, color1, glm::vec2(t1, 1.0));
+                    setVertex(V, C, T, o++, pos2 + newPerp * thickness2, color2, glm::vec2(t2, 0.0));
+
+                    // Triangle 2
+                    setVertex(V, C, T, o++, pos2 + newPerp * thickness2, color2, glm::vec2(t2, 0.0));
+                    setVertex(V, C, T, o++, pos1 - newPerp * thickness1, color1, glm::vec2(t1, 1.0));
+                    setVertex(V, C, T, o++, pos2 - newPerp * thickness2, color2, glm::vec2(t2, 1.0));
+                }
+            }
+        });
+    } else {
+        // Lightweight fallback: simpler straight lines when stride > 1
+        const ofFloatColor sparseColor = ofColor(255, 255, 255, 60);
+        m_pool.parallelFor(drawn - first, kMinNodesPerChunk, [&](int begin, int end) {
+            for (int j = begin; j < end; ++j) {
+                const auto& n = nodes[(size_t)(first + j) * stride];
+                if (n.parentSlot < 0) continue;
+                const auto& p = nodes[n.parentSlot];
+                uint32_t o = kept + m_offsets[j];
+                glm::vec2 dir = glm::normalize(n.pos - p.pos);
+                glm::vec2 perp(-dir.y, dir.x);
+                float thickness = 1.2f;
+
+                setVertex(V, C, T, o++, n.pos + perp * thickness, sparseColor, glm::vec2(1.0, 0.0));
+                setVertex(V, C, T, o++, n.pos - perp * thickness, sparseColor, glm::vec2(1.0, 1.0));
+                setVertex(V, C, T, o++, p.pos + perp * thickness, sparseColor, glm::vec2(0.0, 0.0));
+
+                setVertex(V, C, T, o++, p.pos + perp * thickness, sparseColor, glm::vec2(0.0, 0.0));
+                setVertex(V, C, T, o++, n.pos - perp * thickness, sparseColor, glm::vec2(1.0, 1.0));
+                setVertex(V, C, T, o++, p.pos - perp * thickness, sparseColor, glm::vec2(0.0, 1.0));
+            }
+        });
+    }
+}
+
+void ClusterMesh::buildPoints(const Cluster& cluster, const Style& style, size_t fromNode) {
+    const auto& nodes = cluster.nodes();
+    const int stride = std::max(1, style.stride);
+    const int drawn = ((int)nodes.size() + stride - 1) / stride;
+    const int first = ((int)fromNode + stride - 1) / stride; // drawn nodes [0, first) are kept
+
+    // Unit circle, shared by every node
+    glm::vec2 rim[kCircleResolution + 1];
+    for (int i = 0; i <= kCircleResolution; i++) {
+        float angle = (i / (float)kCircleResolution) * TWO_PI;
+        rim[i] = glm::vec2(cos(angle), sin(angle));
+    }
+
+    // Fixed vertex count per node, so offsets need no counting pass
+    const uint32_t total = (uint32_t)drawn * kPointVertices;
+    auto& verts = m_points.getVertices();
+    auto& colors = m_points.getColors();
+    auto& texs = m_points.getTexCoords();
+    verts.resize(total);
+    colors.resize(total);
+    texs.resize(total);
+    glm::vec3* V = verts.data();
+    ofFloatColor* C = colors.data();
+    glm::vec2* T = texs.data();
+
+    m_pool.parallelFor(drawn - first, kMinNodesPerChunk, [&](int begin, int end) {
+        for (int j = first + begin; j < first + end; ++j) {
+            const auto& node = nodes[(size_t)j * stride];
+            const auto& pos = node.pos;
+            uint32_t o = (uint32_t)j * kPointVertices;
+
+            // Vary particle size based on depth (older = slightly larger)
+            // Make particles bigger to connect better with lines
+            float depthFactor = std::min(1.0f + node.depth * 0.003f, 1.8f);
+            float radius = 2.5f * depthFactor;
+
+            // Vary color intensity based on depth; with topology shading, light up the active tips
+            float colorIntensity = style.topologyShading
+                ? (cluster.isTip(node.id) ? 255.f : 200.f)
+                : ofClamp(200 + node.depth * 0.5f, 200, 255);
+            ofFloatColor particleColor = ofColor(colorIntensity);
+
+            // Circle as a triangle fan with texture coordinates
+            for (int i = 0; i < kCircleResolution; i++) {
+                const glm::vec2& e1 = rim[i];
+                const glm::vec2& e2 = rim[i + 1];
+                setVertex(V, C, T, o++, pos, particleColor, glm::vec2(0.5, 0.5)); // center of circle
+                setVertex(V, C, T, o++, glm::vec2(pos.x + e1.x * radius, pos.y + e1.y * radius),
+                          particleColor, glm::vec2(0.5 + e1.x * 0.5, 0.5 + e1.y * 0.5)); // edge
+                setVertex(V, C, T, o++, glm::vec2(pos.x + e2.x * radius, pos.y + e2.y * radius),
+                          particleColor, glm::vec2(0.5 + e2.x * 0.5, 0.5 + e2.y * 0.5)); // edge
+            }
+        }
+    });
+}
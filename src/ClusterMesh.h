@@ -0,0 +1,57 @@
+#pragma once
+#include "ofMain.h"
+#include "Cluster.h"
+#include "WorkerPool.h"
+
+// Line and point meshes for the whole cluster, rebuilt only when the cluster or style changes.
+//
+// A rebuild runs in two passes over node-range chunks: count each node's vertices, prefix-sum
+// the counts into offsets, size the vertex/colour/texcoord arrays once, then let a persistent
+// worker pool fill the chunks in place. While the cluster only grows (same layout and style,
+// no topology shading) just the new nodes are appended. Output is identical to building the
+// mesh serially.
+class ClusterMesh {
+public:
+    struct Style {
+        int stride = 1;               // draw every stride-th node (decimation)
+        bool topologyShading = false; // see ofApp::topologyShading
+        int maxOrder = 1;             // cluster.maxStrahler(), for alpha scaling
+        bool operator==(const Style& o) const {
+            return stride == o.stride && topologyShading == o.topologyShading && maxOrder == o.maxOrder;
+        }
+    };
+
+    ClusterMesh();
+
+    // Rebuild whichever meshes are requested and out of date
+    void update(const Cluster& cluster, const Style& style, bool wantLines, bool wantPoints);
+
+    const ofMesh& lines() const { return m_lines; }
+    const ofMesh& points() const { return m_points; }
+
+private:
+    struct Key {
+        size_t nodes = 0;
+        int layoutEpoch = -1;
+        Style style;
+        bool operator==(const Key& o) const {
+            return nodes == o.nodes && layoutEpoch == o.layoutEpoch && style == o.style;
+        }
+        // True if a mesh built for this key can be extended to newer by appending nodes
+        bool appendable(const Key& newer) const;
+    };
+
+    // Rebuild for nodes (slots) from fromNode on, keeping what was built for the ones before
+    void buildLines(const Cluster& cluster, const Style& style, size_t fromNode);
+    void buildPoints(const Cluster& cluster, const Style& style, size_t fromNode);
+
+    ofMesh m_lines;
+    ofMesh m_points;
+    Key m_linesKey;
+    Key m_pointsKey;
+    bool m_linesValid = false;
+    bool m_pointsValid = false;
+
+    std::vector<uint32_t> m_offsets; // per rebuilt drawn node, then prefix-summed
+    WorkerPool m_pool;
+};
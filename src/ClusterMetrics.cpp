@@ -0,0 +1,72 @@
+#include "ClusterMetrics.h"
+#include <cstring>
+
+namespace ClusterMetrics {
+
+uint64_t structuralHash(const Cluster& cluster) {
+    uint64_t h = 1469598103934665603ull;
+    auto mix = [&h](uint32_t v) {
+        for (int b = 0; b < 4; ++b) {
+            h ^= (v >> (b * 8)) & 0xffu;
+            h *= 1099511628211ull;
+        }
+    };
+    for (int id = 0; id < (int)cluster.size(); ++id) {
+        const ClusterNode& n = cluster.nodeById(id);
+        uint32_t x, y;
+        std::memcpy(&x, &n.pos.x, sizeof(x));
+        std::memcpy(&y, &n.pos.y, sizeof(y));
+        mix(x);
+        mix(y);
+        mix((uint32_t)n.parent);
+    }
+    return h;
+}
+
+Stats computeStats(const std::vector<ClusterNode>& nodes) {
+    Stats s;
+    s.nodes = (int)nodes.size();
+    if (nodes.size() < 2) return s;
+
+    std::vector<float> radii;
+    radii.reserve(nodes.size());
+    glm::vec2 mean(0, 0);
+    for (const auto& n : nodes) {
+        radii.push_back(glm::length(n.pos));
+        mean += n.pos;
+    }
+    mean = mean / (float)nodes.size();
+    double rg2 = 0.0;
+    for (const auto& n : nodes) rg2 += glm::length2(n.pos - mean);
+    s.radiusOfGyration = (float)std::sqrt(rg2 / nodes.size());
+
+    std::sort(radii.begin(), radii.end());
+    const float rMax = std::max(radii.back(), 1e-3f);
+    auto countWithin = [&radii](float r) {
+        return (double)(std::upper_bound(radii.begin(), radii.end(), r) - radii.begin());
+    };
+
+    for (size_t k = 0; k < s.massProfile.size(); ++k) {
+        s.massProfile[k] = (float)(countWithin(rMax * (k + 1) / s.massProfile.size()) / radii.size());
+    }
+
+    // Least-squares slope over the scaling range: skip the seed's neighbourhood
+    // and the still-growing outer shell
+    const int samples = 16;
+    const float r0 = rMax * 0.05f, r1 = rMax * 0.5f;
+    double sx = 0, sy = 0, sxx = 0, sxy = 0;
+    int used = 0;
+    for (int i = 0; i < samples; ++i) {
+        float r = r0 * std::pow(r1 / r0, i / (float)(samples - 1));
+        double m = countWithin(r);
+        if (m < 1.0) continue;
+        double x = std::log(r), y = std::log(m);
+        sx += x; sy += y; sxx += x * x; sxy += x * y;
+        ++used;
+    }
+    double denom = used * sxx - sx * sx;
+    if (used >= 2 && denom > 0) s.fractalDim = (float)((used * sxy - sx * sy) / denom);
+    return s;
+}
+
+}
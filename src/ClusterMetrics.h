@@ -0,0 +1,23 @@
+#pragma once
+#include "ofMain.h"
+#include "Cluster.h"
+#include <array>
+
+// Structural fingerprints of a grown cluster, used by the golden-run check (ofApp::runGolden).
+namespace ClusterMetrics {
+
+// FNV-1a over the exact bits of every node's position and parent, in stick order.
+// Equal hashes mean a bit-identical cluster, whatever the storage layout.
+uint64_t structuralHash(const Cluster& cluster);
+
+struct Stats {
+    int nodes = 0;
+    float fractalDim = 0.f;       // mass-radius slope of log N(<r) vs log r
+    float radiusOfGyration = 0.f;
+    std::array<float, 10> massProfile{}; // fraction of nodes within (k+1)/10 of the max radius
+};
+
+// Mass-radius statistics around the seed at the origin
+Stats computeStats(const std::vector<ClusterNode>& nodes);
+
+}
@@ -0,0 +1,280 @@
+#include "ControlServer.h"
+#include <cstring>
+
+#ifndef TARGET_WIN32
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+constexpr uint32_t kMaxMessageBytes = 64 * 1024;
+constexpr size_t kNodeRecordBytes = sizeof(float) * 2 + sizeof(int32_t);
+}
+
+ControlServer::~ControlServer() { stop(); }
+
+template<typename T>
+void ControlServer::put(std::vector<uint8_t>& buf, const T& v) {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(&v);
+    buf.insert(buf.end(), p, p + sizeof(T));
+}
+
+void ControlServer::beginMessage(std::vector<uint8_t>& buf, MsgType type, uint32_t payloadBytes) {
+    put<uint32_t>(buf, payloadBytes + 1);
+    put<uint8_t>(buf, type);
+}
+
+void ControlServer::reply(int client, bool ok, const std::string& message) {
+    for (auto& c : m_clients) {
+        if (c.fd != client) continue;
+        beginMessage(c.out, Reply, 1 + (uint32_t)message.size());
+        put<uint8_t>(c.out, ok ? 1 : 0);
+        c.out.insert(c.out.end(), message.begin(), message.end());
+        return;
+    }
+}
+
+bool ControlServer::parseMessages(Client& c, std::vector<Command>& out) {
+    size_t pos = 0;
+    while (c.in.size() - pos >= sizeof(uint32_t)) {
+        uint32_t len;
+        std::memcpy(&len, c.in.data() + pos, sizeof(len));
+        if (len == 0 || len > kMaxMessageBytes) {
+            return false; // garbage framing; drop the connection rather than guess
+        }
+        if (c.in.size() - pos - sizeof(uint32_t) < len) break;
+
+        const uint8_t* msg = c.in.data() + pos + sizeof(uint32_t);
+        MsgType type = (MsgType)msg[0];
+        std::string payload(reinterpret_cast<const char*>(msg + 1), len - 1);
+        pos += sizeof(uint32_t) + len;
+
+        switch (type) {
+            case Ack:
+                if (payload.size() >= sizeof(uint32_t)) {
+                    uint32_t n;
+                    std::memcpy(&n, payload.data(), sizeof(n));
+                    // Acks never rewind; a client asking for less than it acked is ignored
+                    c.acked = std::max(c.acked, std::min(n, c.sent));
+                }
+                break;
+            case Subscribe:
+                if (payload.size() < sizeof(uint32_t) * 2) {
+                    reply(c.fd, false, "Subscribe expects generation, from");
+                    break;
+                }
+                std::memcpy(&c.resumeGeneration, payload.data(), sizeof(uint32_t));
+                std::memcpy(&c.resumeFrom, payload.data() + sizeof(uint32_t), sizeof(uint32_t));
+                c.resumeRequested = true; // applied in stream(), against the current generation
+                break;
+            case SetParam: {
+                size_t split = payload.find('\0');
+                if (split == std::string::npos) {
+                    reply(c.fd, false, "SetParam expects name\\0value");
+                    break;
+                }
+                out.push_back({ c.fd, type, payload.substr(0, split), payload.substr(split + 1) });
+                break;
+            }
+            case Pause: case Resume: case Reset:
+                out.push_back({ c.fd, type, "", "" });
+                break;
+            case Checkpoint: case Load:
+                out.push_back({ c.fd, type, payload, "" });
+                break;
+            default:
+                reply(c.fd, false, "unknown message type " + ofToString((int)type));
+                break;
+        }
+    }
+    c.in.erase(c.in.begin(), c.in.begin() + pos);
+    return true;
+}
+
+#ifndef TARGET_WIN32
+
+bool ControlServer::start(const std::string& socketPath) {
+    stop();
+    sockaddr_un addr{};
+    if (socketPath.size() >= sizeof(addr.sun_path)) {
+        ofLogError("ControlServer") << "Socket path too long: " << socketPath;
+        return false;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        ofLogError("ControlServer") << "socket() failed: " << std::strerror(errno);
+        return false;
+    }
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+    unlink(socketPath.c_str()); // stale socket from a previous run
+
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(fd, 8) != 0) {
+        ofLogError("ControlServer") << "bind/listen on " << socketPath << " failed: " << std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+    m_listenFd = fd;
+    m_path = socketPath;
+    ofLogNotice("ControlServer") << "Listening on " << socketPath;
+    return true;
+}
+
+void ControlServer::closeClient(Client& c) {
+    if (c.fd >= 0) ::close(c.fd);
+    c.fd = -1;
+}
+
+void ControlServer::stop() {
+    for (auto& c : m_clients) closeClient(c);
+    m_clients.clear();
+    if (m_listenFd >= 0) {
+        ::close(m_listenFd);
+        unlink(m_path.c_str());
+        m_listenFd = -1;
+    }
+}
+
+void ControlServer::acceptClients() {
+    for (;;) {
+        int fd = accept(m_listenFd, nullptr, nullptr);
+        if (fd < 0) return; // EAGAIN: nobody waiting
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+#ifdef SO_NOSIGPIPE
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+        Client c;
+        c.fd = fd;
+        m_clients.push_back(std::move(c));
+    }
+}
+
+bool ControlServer::readClient(Client& c, std::vector<Command>& out) {
+    uint8_t buf[4096];
+    bool open = true;
+    for (;;) {
+        ssize_t n = recv(c.fd, buf, sizeof(buf), 0);
+        if (n > 0) {
+            c.in.insert(c.in.end(), buf, buf + n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        open = false; // peer closed or failed; commands it sent before that still count
+        break;
+    }
+    return parseMessages(c, out) && open;
+}
+
+bool ControlServer::flushClient(Client& c) {
+#ifdef MSG_NOSIGNAL
+    const int flags = MSG_NOSIGNAL;
+#else
+    const int flags = 0;
+#endif
+    while (c.outPos < c.out.size()) {
+        ssize_t n = send(c.fd, c.out.data() + c.outPos, c.out.size() - c.outPos, flags);
+        if (n > 0) {
+            c.outPos += (size_t)n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break; // kernel buffer full
+        return false;
+    }
+    if (c.outPos == c.out.size()) {
+        c.out.clear();
+        c.outPos = 0;
+    } else if (c.outPos >= c.out.size() / 2) {
+        // A reader that keeps up only partially never drains the buffer; drop the sent prefix so
+        // the buffer stays around kMaxPendingBytes instead of growing with everything ever sent
+        c.out.erase(c.out.begin(), c.out.begin() + c.outPos);
+        c.outPos = 0;
+    }
+    return true;
+}
+
+#else
+
+bool ControlServer::start(const std::string&) {
+    ofLogError("ControlServer") << "Control socket is not supported on this platform";
+    return false;
+}
+
+void ControlServer::closeClient(Client& c) { c.fd = -1; }
+void ControlServer::stop() {}
+void ControlServer::acceptClients() {}
+bool ControlServer::readClient(Client&, std::vector<Command>&) { return false; }
+bool ControlServer::flushClient(Client&) { return false; }
+
+#endif
+
+void ControlServer::poll(std::vector<Command>& out) {
+    if (m_listenFd < 0) return;
+    acceptClients();
+    for (auto& c : m_clients) {
+        if (!readClient(c, out)) {
+            closeClient(c);
+        }
+    }
+    m_clients.erase(std::remove_if(m_clients.begin(), m_clients.end(),
+                                   [](const Client& c) { return c.fd < 0; }),
+                    m_clients.end());
+}
+
+void ControlServer::stream(const Cluster& cluster, uint32_t generation) {
+    if (m_listenFd < 0) return;
+    const uint32_t total = (uint32_t)cluster.size();
+
+    for (auto& c : m_clients) {
+        if (!c.greeted) {
+            beginMessage(c.out, Hello, sizeof(uint32_t) * 2);
+            put<uint32_t>(c.out, generation);
+            put<uint32_t>(c.out, total);
+            c.greeted = true;
+            c.generation = generation;
+        } else if (c.generation != generation) {
+            beginMessage(c.out, ResetNotice, sizeof(uint32_t));
+            put<uint32_t>(c.out, generation);
+            c.generation = generation;
+            c.acked = c.sent = 0;
+        }
+
+        if (c.resumeRequested) {
+            // A reconnecting client keeps what it already holds of the same generation
+            uint32_t from = c.resumeGeneration == generation ? std::min(c.resumeFrom, total) : 0;
+            c.acked = c.sent = from;
+            c.subscribed = true;
+            c.resumeRequested = false;
+        }
+
+        // Backpressure: leave new nodes in the cluster until the client catches up
+        uint32_t limit = std::min(total, c.acked + kWindow);
+        if (c.subscribed && c.out.size() - c.outPos < kMaxPendingBytes && c.sent < limit) {
+            uint32_t count = limit - c.sent;
+            beginMessage(c.out, Nodes, (uint32_t)(sizeof(uint32_t) * 3 + count * kNodeRecordBytes));
+            put<uint32_t>(c.out, generation);
+            put<uint32_t>(c.out, c.sent);
+            put<uint32_t>(c.out, count);
+            for (uint32_t i = c.sent; i < limit; ++i) {
+                const ClusterNode& n = cluster.nodeById((int)i);
+                put<float>(c.out, n.pos.x);
+                put<float>(c.out, n.pos.y);
+                put<int32_t>(c.out, n.parent);
+            }
+            c.sent = limit;
+        }
+
+        if (!flushClient(c)) {
+            closeClient(c);
+        }
+    }
+    m_clients.erase(std::remove_if(m_clients.begin(), m_clients.end(),
+                                   [](const Client& c) { return c.fd < 0; }),
+                    m_clients.end());
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include "ofMain.h"
+#include "Cluster.h"
+#include <string>
+#include <vector>
+
+// Local control/telemetry endpoint on a Unix-domain socket.
+//
+// Every message is framed as [uint32 length][uint8 type][payload], length counting type + payload,
+// integers and floats in host byte order (the socket is local only).
+//
+// Client -> server:
+//   Subscribe  uint32 generation, uint32 from   start streaming nodes; resumes at from if the
+//                                     generation still matches, else starts over at 0
+//   SetParam   name '\0' value        set a parameter by name; numbers are clamped to its range
+//   Pause / Resume / Reset
+//   Checkpoint path                   save the cluster (relative paths go to bin/data)
+//   Load       path                   replace the cluster with a saved one
+//   Ack        uint32 nodeCount       client holds nodes [0, nodeCount) of the current generation
+//
+// Node indices are stable ids (stick order), independent of the cluster's storage layout.
+//
+// Server -> client:
+//   Hello      uint32 generation, uint32 nodeCount   sent on connect; no Nodes until Subscribe
+//   Reset      uint32 generation      cluster restarted; discard held nodes
+//   Nodes      uint32 generation, uint32 first, uint32 count, count x {float x, float y, int32 parent}
+//   Reply      uint8 ok, message      result of a command
+//
+// Node deltas are cut from the cluster on demand rather than queued per stick, so a slow client
+// simply receives one larger range later. At most kWindow unacknowledged nodes are in flight per
+// client and nothing new is queued while its send buffer is backed up; poll() never blocks.
+class ControlServer {
+public:
+    enum MsgType : uint8_t {
+        SetParam = 1, Pause = 2, Resume = 3, Reset = 4, Checkpoint = 5, Load = 6, Ack = 7,
+        Subscribe = 8,
+        Hello = 0x81, ResetNotice = 0x82, Nodes = 0x83, Reply = 0x84,
+    };
+
+    struct Command {
+        int client;
+        MsgType type;
+        std::string name;   // SetParam name, Checkpoint/Load path
+        std::string value;  // SetParam value
+    };
+
+    ControlServer() = default;
+    ~ControlServer();
+    ControlServer(const ControlServer&) = delete;
+    ControlServer& operator=(const ControlServer&) = delete;
+
+    bool start(const std::string& socketPath);
+    void stop();
+    bool isRunning() const { return m_listenFd >= 0; }
+
+    // Accept clients and read their requests; control commands are appended to out
+    void poll(std::vector<Command>& out);
+    // Stream nodes not yet sent to each client and flush pending output
+    void stream(const Cluster& cluster, uint32_t generation);
+    void reply(int client, bool ok, const std::string& message);
+
+    static constexpr uint32_t kWindow = 16384;           // unacknowledged nodes per client
+    static constexpr size_t kMaxPendingBytes = 1 << 20;  // stop queueing beyond this
+
+private:
+    struct Client {
+        int fd = -1;
+        uint32_t generation = 0;
+        uint32_t acked = 0;   // client confirmed nodes [0, acked)
+        uint32_t sent = 0;    // nodes [0, sent) are queued or delivered
+        bool greeted = false;
+        bool subscribed = false;
+        bool resumeRequested = false;
+        uint32_t resumeGeneration = 0;
+        uint32_t resumeFrom = 0;
+        std::vector<uint8_t> in;
+        std::vector<uint8_t> out;
+        size_t outPos = 0;
+    };
+
+    void acceptClients();
+    void closeClient(Client& c);
+    bool readClient(Client& c, std::vector<Command>& out);
+    bool flushClient(Client& c);
+    bool parseMessages(Client& c, std::vector<Command>& out);
+    static void beginMessage(std::vector<uint8_t>& buf, MsgType type, uint32_t payloadBytes);
+    template<typename T> static void put(std::vector<uint8_t>& buf, const T& v);
+
+    std::string m_path;
+    int m_listenFd = -1;
+    std::vector<Client> m_clients;
+};
@@ -0,0 +1,94 @@
+#include "FlowField.h"
+#include <fstream>
+#include <sstream>
+
+bool FlowField::Definition::operator==(const Definition& o) const {
+    return halfExtent == o.halfExtent && resolution == o.resolution &&
+           radialDrift == o.radialDrift && wind == o.wind &&
+           attractorStrength == o.attractorStrength && attractor == o.attractor &&
+           obstacleMask == o.obstacleMask && obstacles == o.obstacles;
+}
+
+namespace {
+// Brightness in [0,1] of the image pixel under grid cell (x, y); images are stretched over the grid
+float sampleBrightness(const ofPixels& px, int x, int y, int res) {
+    size_t ix = std::min(px.getWidth() - 1, (size_t)((x + 0.5f) / res * px.getWidth()));
+    size_t iy = std::min(px.getHeight() - 1, (size_t)((y + 0.5f) / res * px.getHeight()));
+    return px.getColor(ix, iy).getBrightness() / 255.f;
+}
+}
+
+std::vector<FlowField::Obstacle> FlowField::loadObstacles(const std::string& path) {
+    std::vector<Obstacle> obstacles;
+    std::ifstream in(path);
+    std::string line;
+    int lineNo = 0;
+    while (std::getline(in, line)) {
+        ++lineNo;
+        line = line.substr(0, line.find('#'));
+        std::istringstream ls(line);
+        Obstacle o;
+        if (!(ls >> o.center.x)) continue; // blank or comment
+        if (!(ls >> o.center.y >> o.radius) || o.radius <= 0.f) {
+            ofLogWarning("FlowField") << path << ":" << lineNo << ": expected \"x y radius\"";
+            continue;
+        }
+        obstacles.push_back(o);
+    }
+    return obstacles;
+}
+
+void FlowField::bake(const Definition& def) {
+    m_def = def;
+    m_res = std::max(2, def.resolution);
+    const float cell = 2.f * def.halfExtent / m_res;
+    m_invCell = 1.f / cell;
+    const size_t count = (size_t)m_res * m_res;
+
+    m_drift.assign(count, glm::vec2(0, 0));
+    m_blocked.assign(count, 0);
+
+    const bool useAttractor = def.attractor && def.attractor->isAllocated() && def.attractorStrength != 0.f;
+    m_hasDrift = def.radialDrift != 0.f || def.wind != glm::vec2(0, 0) || useAttractor;
+    m_hasObstacles = !def.obstacles.empty() || (def.obstacleMask && def.obstacleMask->isAllocated());
+
+    std::vector<float> potential;
+    if (useAttractor) {
+        potential.resize(count);
+        for (int y = 0; y < m_res; ++y)
+            for (int x = 0; x < m_res; ++x)
+                potential[(size_t)y * m_res + x] = sampleBrightness(*def.attractor, x, y, m_res);
+    }
+
+    for (int y = 0; y < m_res; ++y) {
+        for (int x = 0; x < m_res; ++x) {
+            const size_t i = (size_t)y * m_res + x;
+            const glm::vec2 p((x + 0.5f) * cell - def.halfExtent, (y + 0.5f) * cell - def.halfExtent);
+
+            glm::vec2 d = def.wind;
+            float r = glm::length(p);
+            if (def.radialDrift != 0.f && r > 1e-3f) d += p * (def.radialDrift / r);
+            if (useAttractor) {
+                // Central differences, normalised so a full black-to-white ramp across one cell
+                // gives attractorStrength
+                int xl = std::max(x - 1, 0), xr = std::min(x + 1, m_res - 1);
+                int yl = std::max(y - 1, 0), yr = std::min(y + 1, m_res - 1);
+                glm::vec2 grad((potential[(size_t)y * m_res + xr] - potential[(size_t)y * m_res + xl]) / (xr - xl),
+                               (potential[(size_t)yr * m_res + x] - potential[(size_t)yl * m_res + x]) / (yr - yl));
+                d += grad * def.attractorStrength;
+            }
+            m_drift[i] = d;
+
+            bool solid = def.obstacleMask && def.obstacleMask->isAllocated() &&
+                         sampleBrightness(*def.obstacleMask, x, y, m_res) < 0.5f;
+            for (const auto& o : def.obstacles) {
+                if (solid) break;
+                solid = glm::length2(p - o.center) <= o.radius * o.radius;
+            }
+            m_blocked[i] = solid ? 1 : 0;
+        }
+    }
+
+    ofLogNotice("FlowField") << "baked " << m_res << "x" << m_res << " over +-" << def.halfExtent
+        << (m_hasDrift ? ", drift" : "") << (m_hasObstacles ? ", obstacles" : "");
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include "ofMain.h"
+
+// Drift and obstacles for biased growth, baked into a square grid centred on the seed.
+//
+// However many layers the definition stacks up, the walker loop only pays for one bilinear
+// drift lookup and one occupancy lookup per step. Outside the grid nothing is blocked and only
+// the analytic layers (radial drift and wind) apply.
+class FlowField {
+public:
+    struct Obstacle {
+        glm::vec2 center;
+        float radius;
+        bool operator==(const Obstacle& o) const { return center == o.center && radius == o.radius; }
+    };
+
+    struct Definition {
+        float halfExtent = 1000.f;    // world units covered in each direction from the seed
+        int resolution = 256;         // cells per side
+        float radialDrift = 0.f;      // world units per step; > 0 pushes outward, < 0 pulls in
+        glm::vec2 wind{ 0.f, 0.f };   // constant drift, world units per step
+        float attractorStrength = 0.f; // drift up the attractor image's brightness gradient
+        const ofPixels* attractor = nullptr; // brightness map stretched over the grid
+        const ofPixels* obstacleMask = nullptr; // dark pixels are blocked
+        std::vector<Obstacle> obstacles;   // circles in world units
+
+        bool operator==(const Definition& o) const;
+        bool operator!=(const Definition& o) const { return !(*this == o); }
+    };
+
+    void bake(const Definition& def);
+    const Definition& definition() const { return m_def; }
+
+    bool hasDrift() const { return m_hasDrift; }
+    bool hasObstacles() const { return m_hasObstacles; }
+
+    glm::vec2 drift(const glm::vec2& p) const {
+        if (!inside(p)) {
+            glm::vec2 d = m_def.wind;
+            float r = glm::length(p);
+            if (m_def.radialDrift != 0.f && r > 1e-3f) d += p * (m_def.radialDrift / r);
+            return d;
+        }
+        float gx = ofClamp((p.x + m_def.halfExtent) * m_invCell - 0.5f, 0.f, (float)(m_res - 1));
+        float gy = ofClamp((p.y + m_def.halfExtent) * m_invCell - 0.5f, 0.f, (float)(m_res - 1));
+        int x0 = std::min((int)gx, m_res - 2), y0 = std::min((int)gy, m_res - 2);
+        float fx = gx - x0, fy = gy - y0;
+        const glm::vec2* row0 = &m_drift[(size_t)y0 * m_res + x0];
+        const glm::vec2* row1 = row0 + m_res;
+        glm::vec2 top = row0[0] + (row0[1] - row0[0]) * fx;
+        glm::vec2 bottom = row1[0] + (row1[1] - row1[0]) * fx;
+        return top + (bottom - top) * fy;
+    }
+
+    bool blocked(const glm::vec2& p) const {
+        if (!inside(p)) return false;
+        int x = (int)ofClamp((p.x + m_def.halfExtent) * m_invCell, 0.f, (float)(m_res - 1));
+        int y = (int)ofClamp((p.y + m_def.halfExtent) * m_invCell, 0.f, (float)(m_res - 1));
+        return m_blocked[(size_t)y * m_res + x] != 0;
+    }
+
+    // True if any point of the segment a->b past a is blocked; sampled every half cell so a
+    // long step cannot jump over a one-cell wall
+    bool blockedAlong(const glm::vec2& a, const glm::vec2& b) const {
+        int samples = std::max(1, (int)std::ceil(glm::length(b - a) * 2.f * m_invCell));
+        glm::vec2 delta = (b - a) / (float)samples;
+        for (int i = 1; i <= samples; ++i) {
+            if (blocked(a + delta * (float)i)) return true;
+        }
+        return false;
+    }
+
+    // Loads obstacle circles from a text file, one "x y radius" per line, '#' starts a comment
+    static std::vector<Obstacle> loadObstacles(const std::string& path);
+
+private:
+    bool inside(const glm::vec2& p) const {
+        return std::abs(p.x) < m_def.halfExtent && std::abs(p.y) < m_def.halfExtent;
+    }
+
+    Definition m_def;
+    int m_res = 2;
+    float m_invCell = 0.f;
+    std::vector<glm::vec2> m_drift = std::vector<glm::vec2>(4);
+    std::vector<uint8_t> m_blocked = std::vector<uint8_t>(4, 0);
+    bool m_hasDrift = false;
+    bool m_hasObstacles = false;
+};
@@ -5,6 +5,7 @@ struct Particle {
     glm::vec2 pos;
     glm::vec2 prevPos;
     bool active = true;
+    int blockedSteps = 0; // drifted moves into an obstacle, less the ones that went through
 
     Particle() = default;
     explicit Particle(const glm::vec2& p) : pos(p), prevPos(p) {}
@@ -0,0 +1,264 @@
+#include "SharedScene.h"
+#include <cstring>
+
+#ifndef TARGET_WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+SharedScene::~SharedScene() { close(); }
+
+size_t SharedScene::segmentSize(uint32_t nodeCapacity, uint32_t walkerCapacity) {
+    return sizeof(Header) + sizeof(Node) * nodeCapacity + sizeof(glm::vec2) * walkerCapacity * 2;
+}
+
+SharedScene::Node* SharedScene::nodeArray() const {
+    return reinterpret_cast<Node*>(reinterpret_cast<char*>(m_header) + sizeof(Header));
+}
+
+glm::vec2* SharedScene::walkerBuffer(uint32_t which) const {
+    char* base = reinterpret_cast<char*>(nodeArray()) + sizeof(Node) * m_header->nodeCapacity;
+    return reinterpret_cast<glm::vec2*>(base) + (size_t)which * m_header->walkerCapacity;
+}
+
+#ifndef TARGET_WIN32
+
+bool SharedScene::create(const std::string& name, uint32_t nodeCapacity, uint32_t walkerCapacity) {
+    close();
+    // Start from a fresh segment so stale viewers see the old one disappear
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+        ofLogError("SharedScene") << "shm_open(" << name << ") failed: " << std::strerror(errno);
+        return false;
+    }
+    size_t size = segmentSize(nodeCapacity, walkerCapacity);
+    if (ftruncate(fd, (off_t)size) != 0) {
+        ofLogError("SharedScene") << "ftruncate failed: " << std::strerror(errno);
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+    void* mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mem == MAP_FAILED) {
+        ofLogError("SharedScene") << "mmap failed: " << std::strerror(errno);
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    m_header = new (mem) Header();
+    m_header->nodeCapacity = nodeCapacity;
+    m_header->walkerCapacity = walkerCapacity;
+    m_header->generation.store(0, std::memory_order_relaxed);
+    m_header->nodeCount.store(0, std::memory_order_relaxed);
+    m_header->frontWalkers.store(0, std::memory_order_relaxed);
+    m_header->walkerSeq[0].store(0, std::memory_order_relaxed);
+    m_header->walkerSeq[1].store(0, std::memory_order_relaxed);
+    m_header->walkerCount[0] = m_header->walkerCount[1] = 0;
+    m_header->viewerPulse.store(0, std::memory_order_relaxed);
+    m_header->publisherPulse.store(0, std::memory_order_relaxed);
+    m_header->version = kVersion;
+    // magic last: viewers treat the segment as valid only once it is set
+    std::atomic_thread_fence(std::memory_order_release);
+    m_header->magic = kMagic;
+
+    m_name = name;
+    m_size = size;
+    m_owner = true;
+    m_published = 0;
+    m_lastPulse = 0;
+    m_watched = false;
+    ofLogNotice("SharedScene") << "Publishing to " << name << " (" << size / 1024 << " KB)";
+    return true;
+}
+
+bool SharedScene::attach(const std::string& name) {
+    close();
+    // Read-write descriptor only so the header can carry our pulse; the data stays read-only
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(Header)) {
+        ::close(fd);
+        return false;
+    }
+    void* mem = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    void* pulse = mmap(nullptr, sizeof(Header), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mem == MAP_FAILED || pulse == MAP_FAILED) {
+        if (mem != MAP_FAILED) munmap(mem, (size_t)st.st_size);
+        if (pulse != MAP_FAILED) munmap(pulse, sizeof(Header));
+        return false;
+    }
+
+    auto* header = static_cast<Header*>(mem);
+    if (header->magic != kMagic || header->version != kVersion ||
+        (size_t)st.st_size < segmentSize(header->nodeCapacity, header->walkerCapacity)) {
+        munmap(mem, (size_t)st.st_size);
+        munmap(pulse, sizeof(Header));
+        return false;
+    }
+
+    m_header = header;
+    m_pulseHeader = static_cast<Header*>(pulse);
+    m_name = name;
+    m_size = (size_t)st.st_size;
+    m_owner = false;
+    m_seenGeneration = std::numeric_limits<uint32_t>::max();
+    m_mirrored = 0;
+    m_device = (uint64_t)st.st_dev;
+    m_inode = (uint64_t)st.st_ino;
+    m_lastHeartbeat = header->publisherPulse.load(std::memory_order_relaxed);
+    m_lastHeartbeatMs = m_lastRelinkCheckMs = ofGetElapsedTimeMillis();
+    ofLogNotice("SharedScene") << "Attached to " << name;
+    return true;
+}
+
+void SharedScene::close() {
+    if (!m_header) return;
+    if (m_owner) m_header->magic = 0; // tells attached viewers to let go
+    munmap(m_header, m_size);
+    if (m_pulseHeader) munmap(m_pulseHeader, sizeof(Header));
+    if (m_owner) shm_unlink(m_name.c_str());
+    m_header = nullptr;
+    m_pulseHeader = nullptr;
+    m_size = 0;
+    m_owner = false;
+}
+
+// A killed publisher never clears magic, so also watch its heartbeat and whether the name
+// still refers to the segment we mapped
+bool SharedScene::publisherAlive() {
+    uint64_t now = ofGetElapsedTimeMillis();
+    uint32_t beat = m_header->publisherPulse.load(std::memory_order_relaxed);
+    if (beat != m_lastHeartbeat) {
+        m_lastHeartbeat = beat;
+        m_lastHeartbeatMs = now;
+    } else if (now - m_lastHeartbeatMs > kPublisherTimeoutMs) {
+        ofLogNotice("SharedScene") << "No heartbeat from " << m_name << ", detaching";
+        return false;
+    }
+
+    if (now - m_lastRelinkCheckMs < kRelinkCheckMs) return true;
+    m_lastRelinkCheckMs = now;
+    int fd = shm_open(m_name.c_str(), O_RDONLY, 0);
+    if (fd < 0) return false; // unlinked
+    struct stat st;
+    bool same = fstat(fd, &st) == 0 && (uint64_t)st.st_dev == m_device && (uint64_t)st.st_ino == m_inode;
+    ::close(fd);
+    if (!same) ofLogNotice("SharedScene") << m_name << " was recreated, detaching";
+    return same;
+}
+
+#else
+
+bool SharedScene::create(const std::string&, uint32_t, uint32_t) {
+    ofLogError("SharedScene") << "Shared-memory publishing is not supported on this platform";
+    return false;
+}
+
+bool SharedScene::attach(const std::string&) { return false; }
+
+bool SharedScene::publisherAlive() { return false; }
+
+void SharedScene::close() { m_header = nullptr; }
+
+#endif
+
+void SharedScene::publishReset() {
+    if (!m_owner) return;
+    m_published = 0;
+    m_header->nodeCount.store(0, std::memory_order_release);
+    m_header->generation.fetch_add(1, std::memory_order_release);
+}
+
+void SharedScene::publishNodes(const Cluster& cluster) {
+    if (!m_owner) return;
+    uint32_t n = (uint32_t)std::min<size_t>(cluster.size(), m_header->nodeCapacity);
+    if (n <= m_published) return;
+    Node* dst = nodeArray();
+    for (uint32_t i = m_published; i < n; ++i) {
+        const ClusterNode& node = cluster.nodeById((int)i);
+        dst[i] = { node.pos.x, node.pos.y, node.parent };
+    }
+    m_published = n;
+    m_header->nodeCount.store(n, std::memory_order_release);
+}
+
+void SharedScene::publishWalkers(const std::vector<Particle>& walkers) {
+    if (!m_owner) return;
+    m_header->publisherPulse.fetch_add(1, std::memory_order_relaxed);
+
+    // Walkers change every frame, so only copy them while a viewer is actually pulling
+    uint32_t pulse = m_header->viewerPulse.load(std::memory_order_relaxed);
+    uint64_t now = ofGetElapsedTimeMillis();
+    if (pulse != m_lastPulse) {
+        m_lastPulse = pulse;
+        m_lastPulseMs = now;
+        m_watched = true;
+    } else if (m_watched && now - m_lastPulseMs > kViewerTimeoutMs) {
+        m_watched = false;
+    }
+    if (!m_watched) return;
+    uint32_t back = 1u - m_header->frontWalkers.load(std::memory_order_relaxed);
+    uint32_t count = (uint32_t)std::min<size_t>(walkers.size(), m_header->walkerCapacity);
+
+    uint32_t seq = m_header->walkerSeq[back].load(std::memory_order_relaxed);
+    m_header->walkerSeq[back].store(seq + 1, std::memory_order_relaxed); // odd: writing
+    std::atomic_thread_fence(std::memory_order_release);
+
+    glm::vec2* dst = walkerBuffer(back);
+    for (uint32_t i = 0; i < count; ++i) dst[i] = walkers[i].pos;
+    m_header->walkerCount[back] = count;
+
+    m_header->walkerSeq[back].store(seq + 2, std::memory_order_release);
+    m_header->frontWalkers.store(back, std::memory_order_release);
+}
+
+bool SharedScene::pull(Cluster& cluster, std::vector<Particle>& walkers) {
+    if (!m_header || m_owner) return false;
+    if (m_header->magic != kMagic) return false; // publisher exited cleanly
+    if (!publisherAlive()) {                       // publisher killed, hung or restarted
+        close();
+        return false;
+    }
+    m_pulseHeader->viewerPulse.fetch_add(1, std::memory_order_relaxed);
+
+    uint32_t gen = m_header->generation.load(std::memory_order_acquire);
+    if (gen != m_seenGeneration) {
+        cluster.reset();
+        m_mirrored = 0;
+        m_seenGeneration = gen;
+    }
+
+    uint32_t count = m_header->nodeCount.load(std::memory_order_acquire);
+    const Node* src = nodeArray();
+    for (uint32_t i = m_mirrored; i < count; ++i) {
+        const Node& n = src[i];
+        if (n.parent < 0) cluster.addSeed({ n.x, n.y });
+        else cluster.addNode({ n.x, n.y }, n.parent);
+    }
+    // A reset during the copy invalidates what we just read; redo it next frame
+    if (m_header->generation.load(std::memory_order_acquire) != gen) {
+        m_seenGeneration = std::numeric_limits<uint32_t>::max();
+    } else {
+        m_mirrored = std::max(m_mirrored, count);
+    }
+
+    uint32_t front = m_header->frontWalkers.load(std::memory_order_acquire);
+    uint32_t seq = m_header->walkerSeq[front].load(std::memory_order_acquire);
+    if (seq & 1u) return true; // mid-write; keep last frame's walkers
+    uint32_t wcount = std::min(m_header->walkerCount[front], m_header->walkerCapacity);
+    const glm::vec2* wsrc = walkerBuffer(front);
+    m_walkerScratch.assign(wsrc, wsrc + wcount);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (m_header->walkerSeq[front].load(std::memory_order_relaxed) != seq) {
+        return true; // publisher lapped us mid-copy; keep last frame's walkers
+    }
+    walkers.resize(wcount);
+    for (uint32_t i = 0; i < wcount; ++i) walkers[i].pos = walkers[i].prevPos = m_walkerScratch[i];
+    return true;
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include "ofMain.h"
+#include "Particle.h"
+#include "Cluster.h"
+#include <atomic>
+#include <limits>
+#include <string>
+
+// Shared-memory segment for watching a running simulation from a separate viewer process.
+// The simulation owns the segment and never blocks on readers:
+//  - nodes are append-only; each node is written once and published by bumping nodeCount
+//  - walker positions are double-buffered behind a per-buffer sequence counter (seqlock), and
+//    only written while a viewer is pulsing; viewers keep their last frame if a copy was torn
+//  - a reset bumps generation so viewers drop their mirror and start over
+//  - the publisher bumps a heartbeat every frame; viewers let go of a segment whose heartbeat
+//    stops or whose name now points at a different segment (publisher killed and restarted)
+class SharedScene {
+public:
+    SharedScene() = default;
+    ~SharedScene();
+    SharedScene(const SharedScene&) = delete;
+    SharedScene& operator=(const SharedScene&) = delete;
+
+    // Simulation side: create (or replace) the named segment
+    bool create(const std::string& name, uint32_t nodeCapacity, uint32_t walkerCapacity);
+    // Viewer side: map an existing segment read-only
+    bool attach(const std::string& name);
+    void close();
+
+    bool isOpen() const { return m_header != nullptr; }
+    bool isOwner() const { return m_owner; }
+
+    // Publisher
+    void publishReset();
+    void publishNodes(const Cluster& cluster); // appends nodes not yet published, in stick order
+    void publishWalkers(const std::vector<Particle>& walkers); // once per frame; also the heartbeat
+
+    // Viewer: bring a local cluster/walker mirror up to date; returns false if the segment is gone
+    bool pull(Cluster& cluster, std::vector<Particle>& walkers);
+
+private:
+    static constexpr uint32_t kMagic = 0x444C4131; // "DLA1"
+    static constexpr uint32_t kVersion = 3;
+    static constexpr uint64_t kViewerTimeoutMs = 1000;    // no pulse for this long: nobody watching
+    static constexpr uint64_t kPublisherTimeoutMs = 3000; // no heartbeat for this long: publisher gone
+    static constexpr uint64_t kRelinkCheckMs = 1000;      // how often viewers re-open the name
+
+    struct Node {
+        float x, y;
+        int32_t parent;
+    };
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t nodeCapacity;
+        uint32_t walkerCapacity;
+        std::atomic<uint32_t> generation;
+        std::atomic<uint32_t> nodeCount;
+        std::atomic<uint32_t> frontWalkers;   // buffer index (0/1) last completed
+        std::atomic<uint32_t> walkerSeq[2];   // odd while the buffer is being written
+        uint32_t walkerCount[2];
+        std::atomic<uint32_t> viewerPulse;    // bumped by viewers on every pull
+        std::atomic<uint32_t> publisherPulse; // bumped by the publisher every frame
+    };
+
+    static size_t segmentSize(uint32_t nodeCapacity, uint32_t walkerCapacity);
+    bool publisherAlive();
+    Node* nodeArray() const;
+    glm::vec2* walkerBuffer(uint32_t which) const;
+
+    std::string m_name;
+    Header* m_header = nullptr;
+    size_t m_size = 0;
+    Header* m_pulseHeader = nullptr; // viewer: writable mapping of the header only
+    bool m_owner = false;
+
+    // publisher state
+    uint32_t m_published = 0;
+    uint32_t m_lastPulse = 0;
+    uint64_t m_lastPulseMs = 0;
+    bool m_watched = false;
+
+    // viewer state
+    uint32_t m_seenGeneration = std::numeric_limits<uint32_t>::max();
+    uint32_t m_mirrored = 0;
+    std::vector<glm::vec2> m_walkerScratch;
+    uint64_t m_device = 0, m_inode = 0;  // identity of the mapped segment
+    uint32_t m_lastHeartbeat = 0;
+    uint64_t m_lastHeartbeatMs = 0;
+    uint64_t m_lastRelinkCheckMs = 0;
+};
@@ -0,0 +1,70 @@
+#include "WorkerPool.h"
+#include <algorithm>
+
+WorkerPool::WorkerPool(int threads) {
+    if (threads <= 0) threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    for (int t = 1; t < threads; ++t) m_workers.emplace_back(&WorkerPool::workerLoop, this);
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_wake.notify_all();
+    for (auto& t : m_workers) t.join();
+}
+
+void WorkerPool::parallelFor(int count, int minChunk, const std::function<void(int, int)>& fn) {
+    int chunks = std::min(threads() * 4, (count + minChunk - 1) / std::max(1, minChunk));
+    if (chunks <= 1 || m_workers.empty()) {
+        if (count > 0) fn(0, count);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_fn = &fn;
+        m_count = count;
+        m_chunks = chunks;
+        m_nextChunk = 0;
+        m_active = (int)m_workers.size();
+        ++m_job;
+    }
+    m_wake.notify_all();
+    runChunks();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this] { return m_active == 0; });
+    m_fn = nullptr;
+}
+
+// Take chunks of the current job until none are left
+void WorkerPool::runChunks() {
+    for (;;) {
+        int c;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_nextChunk >= m_chunks) return;
+            c = m_nextChunk++;
+        }
+        (*m_fn)((int)((int64_t)m_count * c / m_chunks), (int)((int64_t)m_count * (c + 1) / m_chunks));
+    }
+}
+
+void WorkerPool::workerLoop() {
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&] { return m_quit || m_job != seen; });
+            if (m_quit) return;
+            seen = m_job;
+        }
+        runChunks();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_active > 0) continue;
+        }
+        m_done.notify_one();
+    }
+}
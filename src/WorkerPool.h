@@ -0,0 +1,43 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for fork-join loops on the main thread.
+//
+// Threads are started once and sleep on a condition variable between jobs, so a parallel pass
+// costs a wake-up rather than a thread spawn. The calling thread works on the job as well, and
+// parallelFor() returns only after every chunk has finished.
+class WorkerPool {
+public:
+    explicit WorkerPool(int threads = 0); // 0: one per core; the caller counts as one
+    ~WorkerPool();
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    int threads() const { return (int)m_workers.size() + 1; }
+
+    // Calls fn(begin, end) over [0, count) in chunks of at least minChunk items
+    void parallelFor(int count, int minChunk, const std::function<void(int, int)>& fn);
+
+private:
+    void workerLoop();
+    void runChunks();
+
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    uint64_t m_job = 0;      // bumped per parallelFor; workers wait for a new value
+    int m_active = 0;        // workers still inside the current job
+    bool m_quit = false;
+
+    // current job; written before m_job is bumped, read-only while it runs
+    const std::function<void(int, int)>* m_fn = nullptr;
+    int m_count = 0;
+    int m_chunks = 0;
+    int m_nextChunk = 0;     // guarded by m_mutex
+};
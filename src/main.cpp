@@ -1,10 +1,40 @@
 #include "ofMain.h"
+#include "ofAppNoWindow.h"
 #include "ofApp.h"
 
-int main() {
-    ofGLFWWindowSettings settings;
-    settings.setGLVersion(3, 2);   // GL3 core -> GLSL #version 150
-    settings.setSize(1280, 800);
-    ofCreateWindow(settings);
-    ofRunApp(new ofApp());
-}
\ No newline at end of file
+// Usage:
+//   emptyExample                      interactive window
+//   emptyExample --publish /dla       also publish the scene to shared memory
+//   emptyExample --headless --publish /dla
+//   emptyExample --view /dla          draw a scene published by another process
+//   emptyExample --control /tmp/dla.sock   serve the control/telemetry socket (see ControlServer.h)
+//   emptyExample --golden-record golden.txt   grow the fixed-seed golden runs and record them
+//   emptyExample --golden golden.txt [--golden-stats]   compare against a recording, exit 1 on change
+//   add --stick-order to start with mortonLayout off, e.g. to time golden runs both ways
+int main(int argc, char* argv[]) {
+    ofApp* app = new ofApp();
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--headless") app->headless = true;
+        else if (arg == "--publish" && i + 1 < argc) app->publishName = argv[++i];
+        else if (arg == "--view" && i + 1 < argc) app->viewName = argv[++i];
+        else if (arg == "--control" && i + 1 < argc) app->controlPath = argv[++i];
+        else if ((arg == "--golden" || arg == "--golden-record") && i + 1 < argc) {
+            app->goldenRecord = arg == "--golden-record";
+            app->goldenPath = argv[++i];
+            app->headless = true;
+        }
+        else if (arg == "--golden-stats") app->goldenStatsOnly = true;
+        else if (arg == "--stick-order") app->stickOrderLayout = true;
+    }
+
+    if (app->headless) {
+        ofSetupOpenGL(std::make_shared<ofAppNoWindow>(), 1280, 800, OF_WINDOW);
+    } else {
+        ofGLFWWindowSettings settings;
+        settings.setGLVersion(3, 2);   // GL3 core -> GLSL #version 150
+        settings.setSize(1280, 800);
+        ofCreateWindow(settings);
+    }
+    return ofRunApp(app);
+}
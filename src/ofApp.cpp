@@ -1,5 +1,11 @@
 #include "ofApp.h"
+#include "ClusterMetrics.h"
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
 #include <limits>
+#include <sstream>
+#include <typeinfo>
 
 // ---------------- RNG helpers ----------------
 float ofApp::rand01() { return std::generate_canonical<float, 24>(rng); }
@@ -16,31 +22,51 @@ glm::vec2 ofApp::randomPointOnRing(float radius) {
 
 void ofApp::respawnWalker(Particle& w) {
     w.active = true;
+    w.blockedSteps = 0;
     
-    // Random angle
-    float angle = rand01() * TWO_PI;
-    
-    // Random radius with bias towards spawn margin
-    // Use power distribution: higher power = more clustering at the edge
-    float t = rand01();
-    float radiusBias = std::pow(t, 2.0f); // square for bias towards outer edge
-    
-    // Spawn in a range from inner radius to outer radius
-    float minRadius = spawnRadius * 0.5f; // can spawn from 50% to 100% of spawn radius
-    float maxRadius = spawnRadius * 1.5f; // up to 150% for more spread
-    float actualRadius = minRadius + radiusBias * (maxRadius - minRadius);
-    
-    w.pos = glm::vec2(actualRadius * std::cos(angle), actualRadius * std::sin(angle));
+    // A few tries to land outside obstacles; without obstacles the first one always wins
+    for (int attempt = 0; attempt < 8; ++attempt) {
+        // Random angle
+        float angle = rand01() * TWO_PI;
+
+        // Random radius with bias towards spawn margin
+        // Use power distribution: higher power = more clustering at the edge
+        float t = rand01();
+        float radiusBias = std::pow(t, 2.0f); // square for bias towards outer edge
+
+        // Spawn in a range from inner radius to outer radius
+        float minRadius = spawnRadius * 0.5f; // can spawn from 50% to 100% of spawn radius
+        float maxRadius = spawnRadius * 1.5f; // up to 150% for more spread
+        float actualRadius = minRadius + radiusBias * (maxRadius - minRadius);
+
+        w.pos = glm::vec2(actualRadius * std::cos(angle), actualRadius * std::sin(angle));
+        if (!field.hasObstacles() || !field.blocked(w.pos)) break;
+    }
     w.prevPos = w.pos;
 }
 
+// Re-bake only when the field parameters change; stepping then costs the same for any field
+void ofApp::updateField() {
+    FlowField::Definition def;
+    def.halfExtent = fieldExtent.get();
+    def.radialDrift = fieldRadialDrift.get();
+    def.wind = { fieldWindX.get(), fieldWindY.get() };
+    def.attractorStrength = fieldAttractor.get();
+    if (fieldUseFiles) {
+        def.attractor = &attractorPixels;
+        def.obstacleMask = &obstaclePixels;
+        def.obstacles = obstacleCircles;
+    }
+    if (def != field.definition()) field.bake(def);
+}
+
 void ofApp::updateRadii() {
     float ext = std::max(cluster.extent(), 1.f);
     spawnRadius = ext + spawnMargin.get() * 1.5f; // increase spawn radius
     killRadius  = ext + (spawnMargin.get() * 2.0f + killMargin.get()); // adjust kill radius accordingly
 }
 
-// pos is where the walker is; find nearest cluster node and decide if it sticks
+// pos is where the walker is; find nearest cluster node (stable id) and decide if it sticks
 bool ofApp::tryStick(const glm::vec2& pos, int& outParentIdx, float& outNearestDistSq) {
     outParentIdx = -1;
     outNearestDistSq = std::numeric_limits<float>::max();
@@ -49,12 +75,16 @@ bool ofApp::tryStick(const glm::vec2& pos, int& outParentIdx, float& outNearestD
     const auto& nodes = cluster.nodes();
 
     float r2 = stickRadius.get() * stickRadius.get();
+    const bool obstacles = field.hasObstacles();
     for (int idx : neighborCandidates) {
-        const glm::vec2& c = nodes[idx].pos;
-        float d2 = glm::length2(c - pos);
-        if (d2 < outNearestDistSq) {
+        const ClusterNode& c = nodes[idx];
+        // Don't bond through an obstacle: the bond's midpoint has to be free
+        if (obstacles && field.blocked((c.pos + pos) * 0.5f)) continue;
+        float d2 = glm::length2(c.pos - pos);
+        // Ties go to the older node so the result does not depend on storage layout
+        if (d2 < outNearestDistSq || (d2 == outNearestDistSq && c.id < outParentIdx)) {
             outNearestDistSq = d2;
-            outParentIdx = idx;
+            outParentIdx = c.id;
         }
     }
     // Within threshold and passes probability?
@@ -66,8 +96,29 @@ bool ofApp::stepWalker(Particle& w) {
     // random unit step
     float a = rand01() * TWO_PI;
     glm::vec2 step = glm::vec2(std::cos(a), std::sin(a)) * stepSize.get();
+    glm::vec2 drifted = field.hasDrift() ? step + field.drift(w.pos) : step;
     w.prevPos = w.pos;
-    w.pos += step;
+    if (field.hasObstacles()) {
+        // An obstacle was baked on top of the walker
+        if (field.blocked(w.pos)) {
+            respawnWalker(w);
+            return false;
+        }
+        if (!field.blockedAlong(w.pos, w.pos + drifted)) {
+            w.blockedSteps = std::max(0, w.blockedSteps - 1);
+        } else {
+            // Drift stronger than the step would pin the walker against the obstacle's face
+            // for good; take the plain random step instead, and respawn the walker once the
+            // drift pushes it into the obstacle more often than not
+            if (++w.blockedSteps >= 16) {
+                respawnWalker(w);
+                return false;
+            }
+            if (field.blockedAlong(w.pos, w.pos + step)) return false;
+            drifted = step;
+        }
+    }
+    w.pos += drifted;
 
     float r = glm::length(w.pos);
     if (r > killRadius) {
@@ -96,8 +147,8 @@ void ofApp::ensureWalkerCount() {
             walkers.push_back(w);
         }
     } else if ((int)walkers.size() > numWalkers.get()) {
-        walkers.resize(numWalkers.get());
-        walkerStart %= walkers.size();
+        walkers.resize(std::max(0, numWalkers.get()));
+        walkerStart = walkers.empty() ? 0 : walkerStart % walkers.size();
     }
 }
 
@@ -112,56 +163,440 @@ void ofApp::resetSim() {
     // Set spatial hash cell size once (rebuild only if cell size changes later)
     lastCellSize = std::max(stickRadius.get() * 2.f, stepSize.get() * 2.f);
     cluster.rebuildHash(lastCellSize);
+
+    ++generation;
+    sharedScene.publishReset();
+}
+
+void ofApp::updateAutotune(int sticks, uint64_t stepMicros) {
+    if (autotune != autotuneActive) {
+        autotuneActive = autotune;
+        if (autotuneActive) {
+            perfSafeMode = true; // the budget only applies in safe mode
+            autotuner.reset({ numWalkers.get(), std::max(1, frameBudgetMs.get()) });
+            ofLogNotice("Autotuner") << "enabled at numWalkers=" << numWalkers.get()
+                << " frameBudgetMs=" << frameBudgetMs.get() << " targetFps=" << targetFps.get();
+        } else {
+            auto b = autotuner.best();
+            ofLogNotice("Autotuner") << "disabled; best seen numWalkers=" << b.walkers
+                << " frameBudgetMs=" << b.budgetMs << " (" << autotuner.bestRate() << " sticks/s)";
+        }
+    }
+    // Nothing to learn from frames that cannot grow the cluster
+    if (!autotuneActive || (int)cluster.nodes().size() >= maxStuck.get()) return;
+
+    autotuner.addSample(sticks, stepMicros, ofGetLastFrameTime());
+    Autotuner::Settings s{ numWalkers.get(), frameBudgetMs.get() };
+    if (autotuner.update(s, (float)targetFps.get())) {
+        numWalkers = s.walkers;
+        frameBudgetMs = s.budgetMs;
+    }
+}
+
+// ---------------- Golden runs ----------------
+// Grows a fixed set of seeded clusters as fast as possible and either records their fingerprints
+// or compares against a recorded file. Exact mode requires bit-identical clusters; stats mode
+// (for changes that consume the random stream differently) compares each size's ensemble
+// fractal dimension and mass-radius profile instead. Runs are matched by (seed, nodes), and
+// runs missing from an older file are only timed. Returns the process exit status.
+int ofApp::runGolden() {
+    struct Scenario { uint32_t seed; int nodes; };
+    const Scenario scenarios[] = {
+        { 1, 4000 }, { 2, 4000 }, { 3, 4000 }, { 4, 4000 },
+        { 5, 4000 }, { 6, 4000 }, { 7, 4000 }, { 8, 4000 },
+        // large enough for the Z-order relayout to kick in
+        { 1, 12000 }, { 2, 12000 }, { 3, 12000 }, { 4, 12000 },
+        { 5, 12000 }, { 6, 12000 }, { 7, 12000 }, { 8, 12000 },
+    };
+    struct Entry {
+        uint32_t seed = 0;
+        uint64_t hash = 0;
+        ClusterMetrics::Stats stats;
+    };
+
+    // Everything that shapes a run is pinned here rather than taken from the GUI defaults, so
+    // retuning those never invalidates a recording. Changing these does; the file records them.
+    deterministic = true;
+    perfSafeMode = false; // no frame budget: step every walker each pass
+    autotune = false;
+    autoPauseOnMax = false;
+    numWalkers = 1024;
+    stickRadius = 3.0f;
+    stepSize = 2.0f;
+    stickProb = 1.0f;
+    spawnMargin = 40.0f;
+    killMargin = 120.0f;
+    fieldRadialDrift = 0.0f;
+    fieldWindX = 0.0f;
+    fieldWindY = 0.0f;
+    fieldAttractor = 0.0f;
+    fieldUseFiles = false;
+    fieldExtent = 1000.0f;
+    mortonLayout = !stickOrderLayout; // layout must not change hashes; --stick-order times it off
+    std::ostringstream ps;
+    ps << "walkers=" << numWalkers.get() << " stickRadius=" << stickRadius.get() << " stepSize=" << stepSize.get()
+       << " stickProb=" << stickProb.get() << " spawnMargin=" << spawnMargin.get()
+       << " killMargin=" << killMargin.get() << " field=none";
+    const std::string runParams = ps.str();
+
+    ofLogNotice("Golden") << "cluster layout: " << (mortonLayout ? "morton" : "stick order");
+    std::vector<Entry> current;
+    for (const auto& sc : scenarios) {
+        seedParam = sc.seed;
+        maxStuck = sc.nodes;
+        resetSim();
+        uint64_t t0 = ofGetElapsedTimeMicros();
+        while ((int)cluster.nodes().size() < sc.nodes) stepSimulation();
+        float ms = (ofGetElapsedTimeMicros() - t0) / 1000.f;
+
+        Entry e;
+        e.seed = sc.seed;
+        e.hash = ClusterMetrics::structuralHash(cluster);
+        e.stats = ClusterMetrics::computeStats(cluster.nodes());
+        current.push_back(e);
+        ofLogNotice("Golden") << "seed " << sc.seed << ": " << sc.nodes << " nodes in " << ms << " ms, hash "
+            << ofToHex(e.hash) << ", D=" << e.stats.fractalDim << ", Rg=" << e.stats.radiusOfGyration;
+    }
+
+    std::string path = ofToDataPath(goldenPath, true);
+    if (goldenRecord) {
+        std::ofstream out(path);
+        out << "# params: " << runParams << "\n";
+        out << "# seed nodes hash fractalDim radiusOfGyration massProfile[10]\n";
+        for (const auto& e : current) {
+            out << e.seed << " " << e.stats.nodes << " " << e.hash << " "
+                << e.stats.fractalDim << " " << e.stats.radiusOfGyration;
+            for (float f : e.stats.massProfile) out << " " << f;
+            out << "\n";
+        }
+        if (!out) {
+            ofLogError("Golden") << "could not write " << path;
+            return 1;
+        }
+        ofLogNotice("Golden") << "recorded " << current.size() << " runs to " << path;
+        return 0;
+    }
+
+    std::ifstream in(path);
+    std::vector<Entry> golden;
+    std::string line;
+    while (std::getline(in, line)) {
+        const std::string paramsTag = "# params: ";
+        if (line.compare(0, paramsTag.size(), paramsTag) == 0 && line.substr(paramsTag.size()) != runParams) {
+            ofLogWarning("Golden") << "recorded with " << line.substr(paramsTag.size()) << ", running with "
+                << runParams << "; hashes will differ";
+        }
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream ls(line);
+        Entry e;
+        ls >> e.seed >> e.stats.nodes >> e.hash >> e.stats.fractalDim >> e.stats.radiusOfGyration;
+        for (float& f : e.stats.massProfile) ls >> f;
+        if (ls) golden.push_back(e);
+    }
+    if (golden.empty()) {
+        ofLogError("Golden") << "could not read any runs from " << path;
+        return 1;
+    }
+
+    // Pair each run with its recorded counterpart
+    std::vector<Entry> matchedCurrent, matchedGolden;
+    int hashMismatches = 0;
+    for (const auto& e : current) {
+        auto it = std::find_if(golden.begin(), golden.end(), [&e](const Entry& g) {
+            return g.seed == e.seed && g.stats.nodes == e.stats.nodes;
+        });
+        if (it == golden.end()) {
+            ofLogNotice("Golden") << "seed " << e.seed << ", " << e.stats.nodes << " nodes: not in " << path
+                << ", timed only";
+            continue;
+        }
+        matchedCurrent.push_back(e);
+        matchedGolden.push_back(*it);
+        if (e.hash != it->hash) {
+            ++hashMismatches;
+            ofLogWarning("Golden") << "seed " << e.seed << ", " << e.stats.nodes << " nodes: hash "
+                << ofToHex(e.hash) << " != golden " << ofToHex(it->hash);
+        }
+    }
+    if (matchedCurrent.empty()) {
+        ofLogError("Golden") << "no run matches the recorded file";
+        return 1;
+    }
+    if (hashMismatches == 0) {
+        ofLogNotice("Golden") << "PASS: all " << matchedCurrent.size() << " recorded clusters bit-identical";
+        return 0;
+    }
+    if (!goldenStatsOnly) {
+        ofLogError("Golden") << "FAIL: " << hashMismatches << " clusters changed (use --golden-stats if intended)";
+        return 1;
+    }
+
+    // Ensemble comparison per cluster size: mean D within two standard errors (at least 0.03)
+    // and mean mass-radius profile within 0.05 at every radius
+    auto summarize = [](const std::vector<Entry>& es, int nodes, float& meanD, float& stderrD,
+                        std::array<float, 10>& profile) {
+        meanD = 0.f;
+        profile.fill(0.f);
+        size_t count = 0;
+        for (const auto& e : es) {
+            if (e.stats.nodes != nodes) continue;
+            meanD += e.stats.fractalDim;
+            for (size_t k = 0; k < profile.size(); ++k) profile[k] += e.stats.massProfile[k];
+            ++count;
+        }
+        meanD /= count;
+        for (float& p : profile) p /= count;
+        float var = 0.f;
+        for (const auto& e : es) {
+            if (e.stats.nodes == nodes) var += (e.stats.fractalDim - meanD) * (e.stats.fractalDim - meanD);
+        }
+        stderrD = std::sqrt(var / std::max<size_t>(1, count - 1) / count);
+    };
+    std::vector<int> sizes;
+    for (const auto& e : matchedCurrent) {
+        if (std::find(sizes.begin(), sizes.end(), e.stats.nodes) == sizes.end()) sizes.push_back(e.stats.nodes);
+    }
+    bool ok = true;
+    for (int nodes : sizes) {
+        float curD, curErr, goldD, goldErr;
+        std::array<float, 10> curProfile, goldProfile;
+        summarize(matchedCurrent, nodes, curD, curErr, curProfile);
+        summarize(matchedGolden, nodes, goldD, goldErr, goldProfile);
+
+        float tolD = std::max(0.03f, 2.f * std::sqrt(curErr * curErr + goldErr * goldErr));
+        float profileDiff = 0.f;
+        for (size_t k = 0; k < curProfile.size(); ++k) {
+            profileDiff = std::max(profileDiff, std::abs(curProfile[k] - goldProfile[k]));
+        }
+        bool sizeOk = std::abs(curD - goldD) <= tolD && profileDiff <= 0.05f;
+        ok = ok && sizeOk;
+        ofLogNotice("Golden") << nodes << " nodes: " << (sizeOk ? "PASS (statistical)" : "FAIL (statistical)")
+            << ": D " << curD << " vs " << goldD << " (tol " << tolD << "), max mass-profile diff " << profileDiff;
+    }
+    return ok ? 0 : 1;
+}
+
+bool ofApp::loadCheckpoint(const std::string& path) {
+    // Never load more than the shared-memory segment (sized from maxStuck's range) can publish
+    if (!cluster.load(path, (uint32_t)maxStuck.getMax())) return false;
+    lastCellSize = std::max(stickRadius.get() * 2.f, stepSize.get() * 2.f);
+    cluster.rebuildHash(lastCellSize);
+    updateRadii();
+    for (auto& w : walkers) respawnWalker(w);
+
+    ++generation;
+    sharedScene.publishReset();
+    return true;
+}
+
+namespace {
+template<typename T>
+void setClamped(ofAbstractParameter& p, double v) {
+    auto& tp = p.cast<T>();
+    tp = (T)std::min<double>(std::max<double>(v, tp.getMin()), tp.getMax());
+}
+}
+
+// Strict parse of a remote value: numbers must be complete and finite and are clamped to the
+// parameter's min/max, bools accept 0/1/true/false. Anything else is rejected untouched.
+bool ofApp::setParamFromString(ofAbstractParameter& p, const std::string& value) {
+    const std::string type = p.valueType();
+    if (type == typeid(bool).name()) {
+        if (value == "1" || value == "true") p.cast<bool>() = true;
+        else if (value == "0" || value == "false") p.cast<bool>() = false;
+        else return false;
+        return true;
+    }
+
+    char* end = nullptr;
+    double v = std::strtod(value.c_str(), &end);
+    if (value.empty() || end != value.c_str() + value.size() || !std::isfinite(v)) return false;
+
+    if (type == typeid(int).name()) setClamped<int>(p, v);
+    else if (type == typeid(float).name()) setClamped<float>(p, v);
+    else if (type == typeid(uint32_t).name()) setClamped<uint32_t>(p, v);
+    else return false;
+    return true;
+}
+
+void ofApp::handleControlCommands() {
+    controlCommands.clear();
+    control.poll(controlCommands);
+
+    for (const auto& cmd : controlCommands) {
+        switch (cmd.type) {
+            case ControlServer::SetParam:
+                if (!params.contains(cmd.name)) {
+                    control.reply(cmd.client, false, "unknown parameter " + cmd.name);
+                    break;
+                }
+                if (!setParamFromString(params.get(cmd.name), cmd.value)) {
+                    control.reply(cmd.client, false, "bad value for " + cmd.name + ": " + cmd.value);
+                    break;
+                }
+                // Report what was applied, which may be clamped to the parameter's range
+                control.reply(cmd.client, true, cmd.name + "=" + params.get(cmd.name).toString());
+                break;
+            case ControlServer::Pause:
+                paused = true;
+                control.reply(cmd.client, true, "paused");
+                break;
+            case ControlServer::Resume:
+                paused = false;
+                control.reply(cmd.client, true, "running");
+                break;
+            case ControlServer::Reset:
+                resetSim();
+                paused = false;
+                control.reply(cmd.client, true, "reset");
+                break;
+            case ControlServer::Checkpoint: {
+                std::string path = ofToDataPath(cmd.name, true);
+                bool ok = cluster.save(path);
+                control.reply(cmd.client, ok, ok ? "saved " + path : "could not write " + path);
+                break;
+            }
+            case ControlServer::Load: {
+                std::string path = ofToDataPath(cmd.name, true);
+                bool ok = loadCheckpoint(path);
+                control.reply(cmd.client, ok, ok ? "loaded " + path : "could not read " + path);
+                break;
+            }
+            default:
+                break;
+        }
+    }
 }
 
 // ---------------- oF lifecycle ----------------
+namespace {
+// Refresh rate of the primary display, which vertical sync caps the frame rate at
+int displayRefreshRate() {
+    GLFWmonitor* monitor = glfwGetPrimaryMonitor();
+    const GLFWvidmode* mode = monitor ? glfwGetVideoMode(monitor) : nullptr;
+    return mode && mode->refreshRate > 0 ? mode->refreshRate : 60;
+}
+}
+
 void ofApp::setup() {
-    ofSetWindowTitle("DLA — openFrameworks");
-    ofSetFrameRate(60);
+    ofSetWindowTitle(isViewer() ? "DLA — viewer (" + viewName + ")" : "DLA — openFrameworks");
+    ofSetFrameRate(headless ? 0 : 60); // headless runs flat out; nothing to pace against
     ofBackground(18, 25, 38); // dark navy blue
 
-    gui.setup("DLA");
-    gui.add(numWalkers.set("numWalkers", 1024, 32, 8192));
-    gui.add(stickRadius.set("stickRadius", 3.0f, 0.5f, 12.0f));
-    gui.add(stepSize.set("stepSize", 2.0f, 0.25f, 8.0f));
-    gui.add(stickProb.set("stickProb", 1.0f, 0.0f, 1.0f));
-    gui.add(spawnMargin.set("spawnMargin", 40.0f, 4.0f, 200.0f));
-    gui.add(killMargin.set("killMargin", 120.0f, 20.0f, 400.0f));
-    gui.add(maxStuck.set("maxStuck", 20000, 100, 200000));
-    gui.add(seedParam.set("seed", 1337));
-    gui.add(deterministic.set("deterministic", true));
-    gui.add(drawLines.set("drawLines", true));
-    gui.add(drawPoints.set("drawPoints", true));
-    gui.add(drawWalkers.set("drawWalkers", true));
-    gui.add(fadeTrails.set("fadeTrails", true));
-    gui.add(autoPauseOnMax.set("autoPauseOnMax", true));
+    params.setName("DLA");
+    params.add(numWalkers.set("numWalkers", 1024, 32, 8192));
+    params.add(stickRadius.set("stickRadius", 3.0f, 0.5f, 12.0f));
+    params.add(stepSize.set("stepSize", 2.0f, 0.25f, 8.0f));
+    params.add(stickProb.set("stickProb", 1.0f, 0.0f, 1.0f));
+    params.add(spawnMargin.set("spawnMargin", 40.0f, 4.0f, 200.0f));
+    params.add(killMargin.set("killMargin", 120.0f, 20.0f, 400.0f));
+    params.add(maxStuck.set("maxStuck", 20000, 100, 200000));
+    params.add(seedParam.set("seed", 1337));
+    params.add(deterministic.set("deterministic", true));
+    params.add(drawLines.set("drawLines", true));
+    params.add(drawPoints.set("drawPoints", true));
+    params.add(drawWalkers.set("drawWalkers", true));
+    params.add(fadeTrails.set("fadeTrails", true));
+    params.add(topologyShading.set("topologyShading", false));
+
+    // Drift field (all off by default: plain isotropic walk)
+    params.add(fieldRadialDrift.set("fieldRadialDrift", 0.0f, -1.0f, 1.0f));
+    params.add(fieldWindX.set("fieldWindX", 0.0f, -1.0f, 1.0f));
+    params.add(fieldWindY.set("fieldWindY", 0.0f, -1.0f, 1.0f));
+    params.add(fieldAttractor.set("fieldAttractor", 0.0f, -8.0f, 8.0f));
+    params.add(fieldUseFiles.set("fieldUseFiles", false));
+    params.add(fieldExtent.set("fieldExtent", 1000.0f, 200.0f, 4000.0f));
+    params.add(autoPauseOnMax.set("autoPauseOnMax", true));
 
     // NEW: performance controls
-    gui.add(perfSafeMode.set("perfSafeMode", true));
-    gui.add(frameBudgetMs.set("frameBudgetMs", 6, 0, 16));   // ~6ms simulation per frame
-    gui.add(drawMaxNodes.set("drawMaxNodes", 12000, 2000, 60000));
-
-    // Load shaders
-    shaderLoaded = testShader.load("shaders/simple_test");
-    if (shaderLoaded) {
-        ofLogNotice() << "Shader loaded successfully";
-    } else {
-        ofLogError() << "Failed to load shader";
+    params.add(perfSafeMode.set("perfSafeMode", true));
+    params.add(frameBudgetMs.set("frameBudgetMs", 6, 0, 16));   // ~6ms simulation per frame
+    params.add(drawMaxNodes.set("drawMaxNodes", 12000, 2000, 60000));
+    params.add(autotune.set("autotune", false));
+    params.add(targetFps.set("targetFps", 60, 15, 120));
+    params.add(mortonLayout.set("mortonLayout", !stickOrderLayout));
+
+    // Optional field files; images are stretched over the field's extent
+    if (ofFile::doesFileExist("field/attractor.png")) ofLoadImage(attractorPixels, "field/attractor.png");
+    if (ofFile::doesFileExist("field/obstacles.png")) ofLoadImage(obstaclePixels, "field/obstacles.png");
+    if (ofFile::doesFileExist("field/obstacles.txt")) {
+        obstacleCircles = FlowField::loadObstacles(ofToDataPath("field/obstacles.txt", true));
     }
-    
-    backgroundShaderLoaded = backgroundShader.load("shaders/background");
-    if (backgroundShaderLoaded) {
-        ofLogNotice() << "Background shader loaded successfully";
+
+    if (headless) {
+        // Nothing is drawn; keep the GL-dependent parts out of the way
+        ofLogNotice() << "Running headless";
     } else {
-        ofLogError() << "Failed to load background shader";
+        gui.setup(params);
+
+        // Load shaders
+        shaderLoaded = testShader.load("shaders/simple_test");
+        if (shaderLoaded) {
+            ofLogNotice() << "Shader loaded successfully";
+        } else {
+            ofLogError() << "Failed to load shader";
+        }
+
+        backgroundShaderLoaded = backgroundShader.load("shaders/background");
+        if (backgroundShaderLoaded) {
+            ofLogNotice() << "Background shader loaded successfully";
+        } else {
+            ofLogError() << "Failed to load background shader";
+        }
+    }
+
+    if (!goldenPath.empty()) {
+        ofExit(runGolden());
+        return;
+    }
+
+    if (isViewer()) {
+        // Walkers and nodes come from the publishing process
+        if (!sharedScene.attach(viewName)) ofLogWarning() << "Waiting for shared scene " << viewName;
+        return;
+    }
+
+    if (!controlPath.empty()) control.start(controlPath);
+
+    if (!publishName.empty()) {
+        sharedScene.create(publishName, (uint32_t)maxStuck.getMax(), (uint32_t)numWalkers.getMax());
     }
 
     resetSim();
 }
 
 void ofApp::update() {
-    if (paused) return;
+    if (isViewer()) {
+        // Retry until the simulation has created the segment; re-attach if it restarts
+        if (!sharedScene.pull(cluster, walkers) && ofGetFrameNum() % 30 == 0) {
+            sharedScene.attach(viewName);
+        }
+        cluster.flushTopology();
+        updateRadii();
+        return;
+    }
+
+    handleControlCommands();
+
+    // The frame-rate cap follows targetFps so any target the autotuner is given is reachable;
+    // vertical sync would hold the loop at the display's refresh, so it is only kept below that
+    if (!headless && targetFps.get() != appliedFrameRate) {
+        appliedFrameRate = targetFps.get();
+        ofSetFrameRate(appliedFrameRate);
+        ofSetVerticalSync(appliedFrameRate <= displayRefreshRate());
+    }
+
+    if (!paused) stepSimulation();
+    cluster.flushTopology(); // once per frame: subtree masses for everything that stuck
 
+    // Appends new nodes and flips the walker buffer; never waits on viewers
+    sharedScene.publishNodes(cluster);
+    sharedScene.publishWalkers(walkers);
+    // Node deltas since each client's last ack; never blocks on slow clients
+    control.stream(cluster, generation);
+}
+
+void ofApp::stepSimulation() {
     // Only rebuild spatial hash when cell size changes (e.g., on parameter tweaks)
     float wantedCell = std::max(stickRadius.get() * 2.f, stepSize.get() * 2.f);
     if (std::abs(wantedCell - lastCellSize) > 0.01f) {
@@ -170,6 +605,8 @@ void ofApp::update() {
     }
 
     ensureWalkerCount();
+    cluster.setSpatialLayout(mortonLayout);
+    updateField();
 
     // Time-budgeted stepping: spread work across frames
     const auto start = ofGetElapsedTimeMicros();
@@ -180,6 +617,7 @@ void ofApp::update() {
     int total = (int)walkers.size();
     if (total == 0) return;
 
+    const int nodesBefore = (int)cluster.nodes().size();
     int processed = 0;
     int i = (int)walkerStart;
 
@@ -197,6 +635,8 @@ void ofApp::update() {
         }
     }
 
+    updateAutotune((int)cluster.nodes().size() - nodesBefore, ofGetElapsedTimeMicros() - start);
+
     if ((int)cluster.nodes().size() >= maxStuck.get() && autoPauseOnMax.get()) paused = true;
 }
 
@@ -230,6 +670,8 @@ void ofApp::drawScene() {
 
     const auto& nodes = cluster.nodes();
     int N = (int)nodes.size();
+    const bool topoShading = topologyShading.get();
+    const int maxOrder = std::max(1, cluster.maxStrahler());
 
     // Decimate draw if large
     int stride = 1;
@@ -237,130 +679,17 @@ void ofApp::drawScene() {
         stride = std::max(1, (int)std::ceil((float)N / drawMaxNodes.get()));
     }
 
+    // Growth appends to the meshes; stride, shading and layout changes rebuild them on the pool
+    ClusterMesh::Style meshStyle;
+    meshStyle.stride = stride;
+    meshStyle.topologyShading = topoShading;
+    meshStyle.maxOrder = topoShading ? maxOrder : 1; // only shading depends on it
+    clusterMesh.update(cluster, meshStyle, drawLines, drawPoints);
+
     if (drawLines) {
         ofPushStyle();
         ofEnableBlendMode(OF_BLENDMODE_ADD); // additive blending for glow
-        
-        // Batch all lines into a mesh for efficient rendering - use triangles for thickness variation
-        ofMesh linesMesh;
-        linesMesh.setMode(OF_PRIMITIVE_TRIANGLES);
-        
-        if (stride == 1) {
-            for (int k = 0; k < N; ++k) {
-                const auto& n = nodes[k];
-                if (n.parent >= 0) {
-                    const auto& p = nodes[n.parent];
-                    
-                    // Calculate line properties
-                    glm::vec2 dir = n.pos - p.pos;
-                    float lineLength = glm::length(dir);
-                    if (lineLength < 0.01f) continue;
-                    
-                    dir = glm::normalize(dir);
-                    glm::vec2 perpendicular(-dir.y, dir.x);
-                    
-                    // Vary thickness based on depth (deeper = thicker)
-                    float baseThickness = 1.2f + n.depth * 0.003f;
-                    baseThickness = std::min(baseThickness, 2.5f);
-                    
-                    // Create curved line with multiple segments for organic look
-                    int segments = std::max(2, (int)(lineLength / 12.0f));
-                    segments = std::min(segments, 5); // cap for performance
-                    
-                    for (int seg = 0; seg < segments; seg++) {
-                        float t1 = seg / (float)segments;
-                        float t2 = (seg + 1) / (float)segments;
-                        
-                        // Interpolate positions
-                        glm::vec2 pos1 = p.pos + dir * (lineLength * t1);
-                        glm::vec2 pos2 = p.pos + dir * (lineLength * t2);
-                        
-                        // Add very subtle organic wave displacement (reduced)
-                        float waveFreq = 0.2f + (k % 10) * 0.03f; // vary per line
-                        float wave1 = sin(t1 * 6.28f * waveFreq + k * 0.1f) * lineLength * 0.03f;
-                        float wave2 = sin(t2 * 6.28f * waveFreq + k * 0.1f) * lineLength * 0.03f;
-                        
-                        pos1 += perpendicular * wave1;
-                        pos2 += perpendicular * wave2;
-                        
-                        // Thickness taper (thinner at child end) - less taper for consistency
-                        float thickness1 = baseThickness * (0.8f + t1 * 0.2f);
-                        float thickness2 = baseThickness * (0.8f + t2 * 0.2f);
-                        
-                        // Color variation along line
-                        int alpha1 = ofClamp(40 + n.depth + (int)(t1 * 40), 40, 180);
-                        int alpha2 = ofClamp(40 + n.depth + (int)(t2 * 40), 40, 180);
-                        ofColor color1(255, 255, 255, alpha1);
-                        ofColor color2(255, 255, 255, alpha2);
-                        
-                        // Create quad as two triangles
-                        glm::vec2 newPerp = glm::normalize(glm::vec2(-(pos2.y - pos1.y), pos2.x - pos1.x));
-                        
-                        // Triangle 1
-                        linesMesh.addVertex(glm::vec3(pos1 + newPerp * thickness1, 0));
-                        linesMesh.addColor(color1);
-                        linesMesh.addTexCoord(glm::vec2(t1, 0.0)); // flowing texture coord
-                        
-                        linesMesh.addVertex(glm::vec3(pos1 - newPerp * thickness1, 0));
-                        linesMesh.addColor(color1);
-                        linesMesh.addTexCoord(glm::vec2(t1, 1.0));
-                        
-                        linesMesh.addVertex(glm::vec3(pos2 + newPerp * thickness2, 0));
-                        linesMesh.addColor(color2);
-                        linesMesh.addTexCoord(glm::vec2(t2, 0.0));
-                        
-                        // Triangle 2
-                        linesMesh.addVertex(glm::vec3(pos2 + newPerp * thickness2, 0));
-                        linesMesh.addColor(color2);
-                        linesMesh.addTexCoord(glm::vec2(t2, 0.0));
-                        
-                        linesMesh.addVertex(glm::vec3(pos1 - newPerp * thickness1, 0));
-                        linesMesh.addColor(color1);
-                        linesMesh.addTexCoord(glm::vec2(t1, 1.0));
-                        
-                        linesMesh.addVertex(glm::vec3(pos2 - newPerp * thickness2, 0));
-                        linesMesh.addColor(color2);
-                        linesMesh.addTexCoord(glm::vec2(t2, 1.0));
-                    }
-                }
-            }
-        } else {
-            // Lightweight fallback: simpler straight lines when stride > 1
-            ofColor sparseColor(255, 255, 255, 60);
-            for (int k = 0; k < N; k += stride) {
-                const auto& n = nodes[k];
-                if (n.parent >= 0) {
-                    const auto& p = nodes[n.parent];
-                    glm::vec2 dir = glm::normalize(n.pos - p.pos);
-                    glm::vec2 perp(-dir.y, dir.x);
-                    float thickness = 1.2f;
-                    
-                    linesMesh.addVertex(glm::vec3(n.pos + perp * thickness, 0));
-                    linesMesh.addColor(sparseColor);
-                    linesMesh.addTexCoord(glm::vec2(1.0, 0.0));
-                    
-                    linesMesh.addVertex(glm::vec3(n.pos - perp * thickness, 0));
-                    linesMesh.addColor(sparseColor);
-                    linesMesh.addTexCoord(glm::vec2(1.0, 1.0));
-                    
-                    linesMesh.addVertex(glm::vec3(p.pos + perp * thickness, 0));
-                    linesMesh.addColor(sparseColor);
-                    linesMesh.addTexCoord(glm::vec2(0.0, 0.0));
-                    
-                    linesMesh.addVertex(glm::vec3(p.pos + perp * thickness, 0));
-                    linesMesh.addColor(sparseColor);
-                    linesMesh.addTexCoord(glm::vec2(0.0, 0.0));
-                    
-                    linesMesh.addVertex(glm::vec3(n.pos - perp * thickness, 0));
-                    linesMesh.addColor(sparseColor);
-                    linesMesh.addTexCoord(glm::vec2(1.0, 1.0));
-                    
-                    linesMesh.addVertex(glm::vec3(p.pos - perp * thickness, 0));
-                    linesMesh.addColor(sparseColor);
-                    linesMesh.addTexCoord(glm::vec2(0.0, 1.0));
-                }
-            }
-        }
+        const ofMesh& linesMesh = clusterMesh.lines();
         
         // Apply shader and draw all lines in one batch
         if (shaderLoaded && shaderEnabled) {
@@ -381,51 +710,8 @@ void ofApp::drawScene() {
         ofSetColor(255);
         ofFill();
         
-        // Batch draw circles using mesh for better performance
-        ofMesh pointsMesh;
-        pointsMesh.setMode(OF_PRIMITIVE_TRIANGLES);
-        
-        const int circleResolution = 12; // slightly higher for smoother spheres
-        
-        for (int k = 0; k < N; k += stride) {
-            const auto& node = nodes[k];
-            const auto& pos = node.pos;
-            
-            // Vary particle size based on depth (older = slightly larger)
-            // Make particles bigger to connect better with lines
-            float depthFactor = std::min(1.0f + node.depth * 0.003f, 1.8f);
-            float radius = 2.5f * depthFactor;
-            
-            // Vary color intensity based on depth
-            float colorIntensity = ofClamp(200 + node.depth * 0.5f, 200, 255);
-            ofColor particleColor(colorIntensity);
-            
-            // Create a circle as triangle fan with texture coordinates
-            for (int i = 0; i < circleResolution; i++) {
-                float angle1 = (i / (float)circleResolution) * TWO_PI;
-                float angle2 = ((i + 1) / (float)circleResolution) * TWO_PI;
-                
-                float x1 = cos(angle1);
-                float y1 = sin(angle1);
-                float x2 = cos(angle2);
-                float y2 = sin(angle2);
-                
-                // Center vertex
-                pointsMesh.addVertex(glm::vec3(pos, 0));
-                pointsMesh.addColor(particleColor);
-                pointsMesh.addTexCoord(glm::vec2(0.5, 0.5)); // center of circle
-                
-                // Edge vertex 1
-                pointsMesh.addVertex(glm::vec3(pos.x + x1 * radius, pos.y + y1 * radius, 0));
-                pointsMesh.addColor(particleColor);
-                pointsMesh.addTexCoord(glm::vec2(0.5 + x1 * 0.5, 0.5 + y1 * 0.5)); // edge
-                
-                // Edge vertex 2
-                pointsMesh.addVertex(glm::vec3(pos.x + x2 * radius, pos.y + y2 * radius, 0));
-                pointsMesh.addColor(particleColor);
-                pointsMesh.addTexCoord(glm::vec2(0.5 + x2 * 0.5, 0.5 + y2 * 0.5)); // edge
-            }
-        }
+        // Batched circles, built by ClusterMesh
+        const ofMesh& pointsMesh = clusterMesh.points();
         
         // Apply shader and draw all points in one batch
         if (shaderLoaded && shaderEnabled) {
@@ -469,6 +755,8 @@ void ofApp::drawScene() {
 }
 
 void ofApp::draw() {
+    if (headless) return;
+
     drawScene();
     
     // Update GIF recording if active
@@ -497,11 +785,28 @@ void ofApp::exportPNG() const {
     ofLogNotice() << "Saved DLA_" << ts << ".png";
 }
 
+void ofApp::exportNodesCSV() const {
+    auto ts = ofGetTimestampString("%Y%m%d_%H%M%S");
+    std::string name = "DLA_nodes_" + ts + ".csv";
+    std::ofstream out(ofToDataPath(name, true));
+    out << "id,x,y,parent,depth,subtreeMass,strahler,tip\n";
+    for (int id = 0; id < (int)cluster.size(); ++id) {
+        const ClusterNode& n = cluster.nodeById(id);
+        out << n.id << "," << n.pos.x << "," << n.pos.y << "," << n.parent << "," << n.depth << ","
+            << cluster.subtreeMass(id) << "," << cluster.strahler(id) << "," << (cluster.isTip(id) ? 1 : 0) << "\n";
+    }
+    ofLogNotice() << "Saved " << name << " (" << cluster.size() << " nodes)";
+}
+
 void ofApp::keyPressed(int key) {
+    // The viewer only mirrors the simulation; ignore keys that would change it
+    if (isViewer() && (key == 'r' || key == 's' || key == OF_KEY_UP || key == OF_KEY_DOWN)) return;
+
     switch (key) {
         case ' ': paused = !paused; break;
         case 'r': resetSim(); paused = false; break;
         case 'e': exportPNG(); break;
+        case 'x': exportNodesCSV(); break;
         case 'g': startGifRecording(); break; // Start GIF recording
         case 's': deterministic = !deterministic; resetSim(); break;
         case 'l': drawLines = !drawLines; break;
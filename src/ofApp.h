@@ -3,6 +3,11 @@
 #include "ofxGui.h"
 #include "Particle.h"
 #include "Cluster.h"
+#include "SharedScene.h"
+#include "ControlServer.h"
+#include "Autotuner.h"
+#include "FlowField.h"
+#include "ClusterMesh.h"
 #include <random>
 
 class ofApp : public ofBaseApp {
@@ -15,6 +20,16 @@ public:
     void mouseScrolled(int x, int y, float scrollX, float scrollY) override;
     void windowResized(int w, int h) override;
 
+    // Launch options (set from main() before ofRunApp)
+    bool headless = false;       // no window, no GUI, no shaders
+    std::string publishName;     // non-empty: publish scene to this shared-memory segment
+    std::string viewName;        // non-empty: draw a scene published by another process
+    std::string controlPath;     // non-empty: serve the control socket at this path
+    std::string goldenPath;      // non-empty: run the golden-run check headlessly and exit
+    bool goldenRecord = false;   // write goldenPath instead of comparing against it
+    bool goldenStatsOnly = false; // accept hash changes if the statistics still match
+    bool stickOrderLayout = false; // start with mortonLayout off (for A/B timing)
+
 private:
     // Simulation
     Cluster cluster;
@@ -26,6 +41,7 @@ private:
 
     // Params (GUI)
     ofxPanel gui;
+    ofParameterGroup params;
     ofParameter<int> numWalkers;
     ofParameter<float> stickRadius;
     ofParameter<float> stepSize;
@@ -39,12 +55,24 @@ private:
     ofParameter<bool> drawPoints;
     ofParameter<bool> drawWalkers;
     ofParameter<bool> fadeTrails;
+    ofParameter<bool> topologyShading; // thickness from subtree mass, alpha from Strahler order
     ofParameter<bool> autoPauseOnMax;
 
     // NEW: performance controls
     ofParameter<int> frameBudgetMs;      // per-frame CPU budget for stepping walkers
     ofParameter<int> drawMaxNodes;       // max nodes to draw each frame before decimating
     ofParameter<bool> perfSafeMode;      // enable budgets/decimation
+    ofParameter<bool> autotune;          // let Autotuner drive numWalkers/frameBudgetMs
+    ofParameter<int> targetFps;          // frame-rate cap (windowed), which the autotuner must hold
+    ofParameter<bool> mortonLayout;      // periodically re-sort cluster storage in Z-order
+
+    // Drift field (baked into FlowField whenever these change)
+    ofParameter<float> fieldRadialDrift; // world units per step, + outward
+    ofParameter<float> fieldWindX;
+    ofParameter<float> fieldWindY;
+    ofParameter<float> fieldAttractor;   // drift up bin/data/field/attractor.png brightness
+    ofParameter<bool> fieldUseFiles;     // use attractor.png, obstacles.png (dark = blocked), obstacles.txt
+    ofParameter<float> fieldExtent;      // half-width of the baked grid in world units
 
     // State
     bool paused = false;
@@ -55,14 +83,18 @@ private:
     // Helpers
     void initRNG();
     void resetSim();
+    void stepSimulation();
+    bool loadCheckpoint(const std::string& path);
     void ensureWalkerCount();
     glm::vec2 randomPointOnRing(float radius);
     void respawnWalker(Particle& w);
     bool stepWalker(Particle& w); // returns true if stuck this frame
     bool tryStick(const glm::vec2& pos, int& outParentIdx, float& outNearestDistSq);
     void updateRadii();
+    void updateField();
     void drawScene();
     void exportPNG() const;
+    void exportNodesCSV() const;
 
     // Spatial hash rebuild management
     float lastCellSize = -1.f;
@@ -70,9 +102,38 @@ private:
     // Time-budgeted stepping
     size_t walkerStart = 0; // rotating index across frames
 
+    // Throughput autotuning
+    Autotuner autotuner;
+    bool autotuneActive = false;
+    int appliedFrameRate = 0; // frame-rate cap and vsync last applied for; 0 = not yet
+    void updateAutotune(int sticks, uint64_t stepMicros);
+
+    // Golden runs: fixed-seed clusters compared by hash or by statistics
+    int runGolden();
+
     // Cached query buffer
     std::vector<int> neighborCandidates;
+
+    // Biased growth
+    FlowField field;
+    ofPixels attractorPixels;
+    ofPixels obstaclePixels;
+    std::vector<FlowField::Obstacle> obstacleCircles;
+
+    // Shared-memory publishing / viewing
+    SharedScene sharedScene;
+    bool isViewer() const { return !viewName.empty(); }
+
+    // Control socket
+    ControlServer control;
+    std::vector<ControlServer::Command> controlCommands;
+    uint32_t generation = 0; // bumped whenever the cluster is replaced
+    void handleControlCommands();
+    bool setParamFromString(ofAbstractParameter& p, const std::string& value);
     
+    // Cached cluster geometry
+    ClusterMesh clusterMesh;
+
     // Shaders
     ofShader testShader;
     ofShader backgroundShader;